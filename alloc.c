@@ -0,0 +1,108 @@
+/* 
+  A fully functional SDL3 window with a custom-drawn non-client area and shadow 
+  Copyright (C) 2025 fischflocke
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Standard includes
+#include <stdbool.h>
+
+// SDL3 includes
+#include <SDL3/SDL.h>
+
+// Local includes
+#include "alloc.h"
+
+static void countAlloc(size_t size);
+static void *SDLCALL countingMalloc(size_t size);
+static void *SDLCALL countingCalloc(size_t nmemb, size_t size);
+static void *SDLCALL countingRealloc(void *mem, size_t size);
+
+static const char *phaseNames[ALLOC_PHASES] = {
+    "startup", "event", "layout", "draw", "present", "capture", "background"
+};
+
+/* Every allocation made through SDL, which includes SDL_image, SDL_ttf and this program, passes
+ * through the counting functions. The main thread's phase and counters are only touched by the
+ * main thread, other threads only count atomically. */
+static struct {
+    SDL_malloc_func malloc;
+    SDL_calloc_func calloc;
+    SDL_realloc_func realloc;
+    SDL_free_func free;
+    SDL_ThreadID mainThread;
+    allocPhase phase;
+    Uint64 count[ALLOC_PHASES];
+    Uint64 bytes[ALLOC_PHASES];
+    SDL_AtomicInt backgroundCount;
+    SDL_AtomicInt backgroundKilobytes;
+} allocs;
+
+bool initAllocTracking(void) {
+    // This has to happen before anything is allocated through SDL
+    SDL_GetOriginalMemoryFunctions(&allocs.malloc, &allocs.calloc, &allocs.realloc, &allocs.free);
+    allocs.mainThread = SDL_GetCurrentThreadID();
+    allocs.phase = ALLOC_STARTUP;
+    return SDL_SetMemoryFunctions(countingMalloc, countingCalloc, countingRealloc, allocs.free);
+}
+
+allocPhase setAllocPhase(allocPhase phase) {
+    allocPhase previous = allocs.phase;
+    allocs.phase = phase;
+    return previous;
+}
+
+Uint64 getAllocCount(allocPhase phase) {
+    if (phase == ALLOC_BACKGROUND)
+        return SDL_GetAtomicInt(&allocs.backgroundCount);
+    return allocs.count[phase];
+}
+
+Uint64 getAllocBytes(allocPhase phase) {
+    if (phase == ALLOC_BACKGROUND)
+        return (Uint64)SDL_GetAtomicInt(&allocs.backgroundKilobytes) * 1024;
+    return allocs.bytes[phase];
+}
+
+const char *getAllocPhaseName(allocPhase phase) {
+    return phaseNames[phase];
+}
+
+static void countAlloc(size_t size) {
+    if (SDL_GetCurrentThreadID() != allocs.mainThread) {
+        // Background threads allocate large buffers, so their bytes are counted in kilobytes
+        SDL_AddAtomicInt(&allocs.backgroundCount, 1);
+        SDL_AddAtomicInt(&allocs.backgroundKilobytes, (int)((size + 1023) / 1024));
+        return;
+    }
+    allocs.count[allocs.phase]++;
+    allocs.bytes[allocs.phase] += size;
+}
+
+static void *SDLCALL countingMalloc(size_t size) {
+    countAlloc(size);
+    return allocs.malloc(size);
+}
+
+static void *SDLCALL countingCalloc(size_t nmemb, size_t size) {
+    countAlloc(nmemb * size);
+    return allocs.calloc(nmemb, size);
+}
+
+static void *SDLCALL countingRealloc(void *mem, size_t size) {
+    // Shrinking or growing in place still counts, the heap may have to move the block
+    countAlloc(size);
+    return allocs.realloc(mem, size);
+}
@@ -0,0 +1,48 @@
+/* 
+  A fully functional SDL3 window with a custom-drawn non-client area and shadow 
+  Copyright (C) 2025 fischflocke
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef ALLOC_H
+#define ALLOC_H
+
+// Standard includes
+#include <stdbool.h>
+
+// SDL3 includes
+#include <SDL3/SDL.h>
+
+// Phases of the main thread that allocations are attributed to
+typedef enum {
+    ALLOC_STARTUP,
+    ALLOC_EVENT,
+    ALLOC_LAYOUT,
+    ALLOC_DRAW,
+    ALLOC_PRESENT,
+    // Reading back frames for captures, which SDL can only do into a new surface
+    ALLOC_CAPTURE,
+    // Any thread other than the main thread
+    ALLOC_BACKGROUND,
+    ALLOC_PHASES
+} allocPhase;
+
+bool initAllocTracking(void);
+allocPhase setAllocPhase(allocPhase phase);
+Uint64 getAllocCount(allocPhase phase);
+Uint64 getAllocBytes(allocPhase phase);
+const char *getAllocPhaseName(allocPhase phase);
+
+#endif
@@ -0,0 +1,537 @@
+/* 
+  A fully functional SDL3 window with a custom-drawn non-client area and shadow 
+  Copyright (C) 2025 fischflocke
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Standard includes
+#include <stdbool.h>
+
+// Platform includes
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <errno.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+// SDL3 includes
+#include <SDL3/SDL.h>
+
+// Local includes
+#include "appearance.h"
+#include "palette.h"
+
+// Number of derived palettes that are remembered, a power of two
+#define PALETTE_CACHE_SIZE 16
+#ifdef __linux__
+// D-Bus constants, so neither its headers nor its library are needed to build
+#define DBUS_BUS_SESSION 0
+#define DBUS_TYPE_INVALID 0
+#define DBUS_TYPE_STRING 's'
+#define DBUS_TYPE_VARIANT 'v'
+#define DBUS_TYPE_STRUCT 'r'
+#define DBUS_TYPE_DOUBLE 'd'
+#define DBUS_TYPE_UINT32 'u'
+#define DBUS_MESSAGE_TYPE_METHOD_RETURN 2
+#define DBUS_MESSAGE_TYPE_SIGNAL 4
+// Bits of the cached portal settings, next to the accent's 0xRRGGBB
+#define PORTAL_HAS_ACCENT (1 << 24)
+#define PORTAL_HIGH_CONTRAST (1 << 25)
+#endif
+
+// Everything a derived palette depends on
+typedef struct {
+    palette base;
+    appearance settings;
+} paletteKey;
+
+#ifdef __linux__
+// libdbus's opaque structures, sized and aligned generously
+typedef struct {
+    const char *name;
+    const char *message;
+    unsigned int flags;
+    void *padding;
+} dbusError;
+typedef struct {
+    void *opaque[16];
+} dbusIter;
+#endif
+
+static bool readSystemAppearance(void *data, appearance *settings);
+#ifdef _WIN32
+static void readWindowsAppearance(appearance *settings);
+#elif defined(__linux__)
+static int watchPortal(void *data);
+static bool loadDBus(void);
+static void *connectPortal(void);
+static void handlePortalMessage(void *message);
+static bool readPortalValue(dbusIter *iter, int type, void *values, int count);
+#endif
+static bool readMockAppearance(void *data, appearance *settings);
+static void computePalette(const palette *base, const appearance *settings, palette *colors);
+static SDL_Color ensureContrast(SDL_Color color, SDL_Color against, float ratio);
+
+/* Derived palettes by their inputs. Theme notifications often repeat the same settings, which then
+ * only cost hashing the key. */
+static struct {
+    bool used[PALETTE_CACHE_SIZE];
+    paletteKey keys[PALETTE_CACHE_SIZE];
+    palette colors[PALETTE_CACHE_SIZE];
+    int hits;
+    int misses;
+} paletteCache;
+
+// Settings returned by the mock source
+static appearance mockSettings;
+
+#ifdef __linux__
+/* The accent color and the contrast preference come from the desktop portal's settings, which SDL
+ * doesn't expose. A worker reads them without blocking the main thread and follows the portal's
+ * change signal, reading the settings is then only an atomic load. The worker has its own
+ * connection, as libdbus would exit the process if the shared one lost the bus. libdbus is loaded
+ * at runtime, SDL has it loaded on Linux desktops anyway. */
+static struct {
+    SDL_Thread *watcher;
+    SDL_AtomicInt stop;
+    // Wakes the watcher when it should stop
+    int wake;
+    // Portal settings as PORTAL_* bits and the accent, or 0 before they are known
+    SDL_AtomicInt settings;
+    // Serials of the initial reads, to match their replies
+    Uint32 accentSerial;
+    Uint32 contrastSerial;
+    SDL_SharedObject *lib;
+    // libdbus functions
+    int (*threadsInitDefault)(void);
+    void (*errorInit)(dbusError *error);
+    void (*errorFree)(dbusError *error);
+    void *(*busGetPrivate)(int type, dbusError *error);
+    void (*busAddMatch)(void *connection, const char *rule, dbusError *error);
+    void (*setExitOnDisconnect)(void *connection, Uint32 exit);
+    Uint32 (*getUnixFd)(void *connection, int *fd);
+    Uint32 (*getIsConnected)(void *connection);
+    Uint32 (*readWrite)(void *connection, int timeout);
+    void *(*popMessage)(void *connection);
+    Uint32 (*send)(void *connection, void *message, Uint32 *serial);
+    void (*flush)(void *connection);
+    void (*close)(void *connection);
+    void (*connectionUnref)(void *connection);
+    void *(*newMethodCall)(const char *destination, const char *path, const char *iface,
+                           const char *method);
+    Uint32 (*appendArgs)(void *message, int type, ...);
+    int (*getType)(void *message);
+    Uint32 (*getReplySerial)(void *message);
+    Uint32 (*isSignal)(void *message, const char *iface, const char *name);
+    void (*unref)(void *message);
+    Uint32 (*iterInit)(void *message, dbusIter *iter);
+    int (*iterGetArgType)(dbusIter *iter);
+    void (*iterRecurse)(dbusIter *iter, dbusIter *sub);
+    void (*iterGetBasic)(dbusIter *iter, void *value);
+    Uint32 (*iterNext)(dbusIter *iter);
+} portal;
+#endif
+
+appearanceSource getSystemAppearance(void) {
+    return (appearanceSource){readSystemAppearance, NULL};
+}
+
+bool watchSystemAppearance(void) {
+#ifdef __linux__
+    if (portal.watcher)
+        return true;
+
+    // Changes arrive as theme change events, like the light or dark mode's
+    portal.wake = eventfd(0, EFD_CLOEXEC);
+    if (portal.wake < 0)
+        return SDL_SetError("Failed to create an eventfd");
+    portal.watcher = SDL_CreateThread(watchPortal, "appearance watcher", NULL);
+    if (!portal.watcher) {
+        close(portal.wake);
+        return false;
+    }
+    return true;
+#else
+    // Windows reports accent and contrast changes as theme changes itself
+    return SDL_SetError("Watching the appearance settings is only supported on Linux");
+#endif
+}
+
+void unwatchSystemAppearance(void) {
+#ifdef __linux__
+    if (!portal.watcher)
+        return;
+    SDL_SetAtomicInt(&portal.stop, 1);
+    eventfd_write(portal.wake, 1);
+    SDL_WaitThread(portal.watcher, NULL);
+    portal.watcher = NULL;
+    close(portal.wake);
+#endif
+}
+
+appearanceSource getMockAppearance(const char *spec) {
+    /* The spec is a comma separated list of "light" or "dark", "accent=RRGGBB" and
+     * "contrast=high" or "contrast=normal", for example "dark,accent=3584e4,contrast=high" */
+    SDL_zero(mockSettings);
+    for (const char *p = spec; p && *p;) {
+        const char *end = SDL_strchr(p, ',');
+        size_t len = end ? (size_t)(end - p) : SDL_strlen(p);
+        if (len == 4 && SDL_strncmp(p, "dark", 4) == 0) {
+            mockSettings.dark = true;
+        } else if (len == 5 && SDL_strncmp(p, "light", 5) == 0) {
+            mockSettings.dark = false;
+        } else if (len == 13 && SDL_strncmp(p, "accent=", 7) == 0) {
+            Uint32 rgb = SDL_strtoul(p + 7, NULL, 16);
+            mockSettings.hasAccent = true;
+            mockSettings.accent = (SDL_Color){rgb >> 16 & 0xff, rgb >> 8 & 0xff, rgb & 0xff, 255};
+        } else if (len == 13 && SDL_strncmp(p, "contrast=high", 13) == 0) {
+            mockSettings.highContrast = true;
+        } else if (len == 15 && SDL_strncmp(p, "contrast=normal", 15) == 0) {
+            mockSettings.highContrast = false;
+        }
+        p = end ? end + 1 : NULL;
+    }
+    return (appearanceSource){readMockAppearance, &mockSettings};
+}
+
+bool readAppearance(const appearanceSource *source, appearance *settings) {
+    SDL_zerop(settings);
+    return source->read(source->data, settings);
+}
+
+void derivePalette(const palette *base, const appearance *settings, palette *colors) {
+    // Zeroed, so padding doesn't affect the hash
+    paletteKey key;
+    SDL_zero(key);
+    key.base = *base;
+    key.settings.dark = settings->dark;
+    key.settings.hasAccent = settings->hasAccent;
+    key.settings.accent = settings->hasAccent ? settings->accent : (SDL_Color){0, 0, 0, 0};
+    key.settings.highContrast = settings->highContrast;
+
+    // Probe from the key's slot, and replace the entry there if it isn't cached
+    Uint32 hash = SDL_murmur3_32(&key, sizeof(key), 0);
+    int slot = hash & (PALETTE_CACHE_SIZE - 1);
+    for (int i = 0; i < 4; i++) {
+        int probe = (slot + i) & (PALETTE_CACHE_SIZE - 1);
+        if (paletteCache.used[probe] &&
+            SDL_memcmp(&paletteCache.keys[probe], &key, sizeof(key)) == 0) {
+            paletteCache.hits++;
+            *colors = paletteCache.colors[probe];
+            return;
+        }
+        if (!paletteCache.used[probe]) {
+            slot = probe;
+            break;
+        }
+    }
+
+    paletteCache.misses++;
+    computePalette(base, &key.settings, colors);
+    paletteCache.used[slot] = true;
+    paletteCache.keys[slot] = key;
+    paletteCache.colors[slot] = *colors;
+}
+
+bool checkPalettes(void) {
+    /* Derive palettes for both modes, a few accents and both contrast levels through the mock
+     * source, and check that the title and the high contrast border are readable */
+    const char *specs[] = {
+        "light", "dark", "light,contrast=high", "dark,contrast=high",
+        "light,accent=3584e4", "dark,accent=3584e4", "light,accent=ffd700,contrast=high",
+        "dark,accent=1c1c8c,contrast=high", "light,accent=e01b24", "dark,accent=ffffff",
+        "light,accent=000000,contrast=high", "dark,accent=808080"
+    };
+    const palette bases[] = {
+        {{200, 200, 200, 255}, {227, 227, 227, 255}, {255, 255, 255, 255}, {40, 40, 40, 255}},
+        {{55, 55, 55, 255}, {27, 27, 27, 255}, {0, 0, 0, 255}, {230, 230, 230, 255}}
+    };
+
+    int failures = 0;
+    for (int pass = 0; pass < 2; pass++) {
+        for (size_t i = 0; i < SDL_arraysize(specs); i++) {
+            appearanceSource source = getMockAppearance(specs[i]);
+            appearance settings;
+            readAppearance(&source, &settings);
+            palette colors;
+            derivePalette(&bases[settings.dark], &settings, &colors);
+
+            float text = getContrastRatio(colors.text, colors.titleBar);
+            float border = getContrastRatio(colors.border, colors.background);
+            bool ok = text >= (settings.highContrast ? 7 : 4.5f) &&
+                      (!settings.highContrast || border >= 3);
+            if (!ok) {
+                SDL_Log("Palette check failed: %s, text contrast %.2f, border contrast %.2f",
+                        specs[i], text, border);
+                failures++;
+            }
+        }
+    }
+
+    // The second pass must have been served from the cache
+    SDL_Log("Palette check: %d failures, %d cache hits, %d misses", failures, paletteCache.hits,
+            paletteCache.misses);
+    return failures == 0 && paletteCache.hits >= (int)SDL_arraysize(specs);
+}
+
+static bool readSystemAppearance(void *data, appearance *settings) {
+    // SDL tells light from dark, the rest is asked from the platform
+    settings->dark = SDL_GetSystemTheme() == SDL_SYSTEM_THEME_DARK;
+#ifdef _WIN32
+    readWindowsAppearance(settings);
+#elif defined(__linux__)
+    int cached = SDL_GetAtomicInt(&portal.settings);
+    settings->hasAccent = cached & PORTAL_HAS_ACCENT;
+    settings->accent = (SDL_Color){cached >> 16 & 0xff, cached >> 8 & 0xff, cached & 0xff, 255};
+    settings->highContrast = cached & PORTAL_HIGH_CONTRAST;
+#endif
+    return true;
+}
+
+#ifdef _WIN32
+static void readWindowsAppearance(appearance *settings) {
+    HIGHCONTRASTW contrast = {sizeof(contrast)};
+    if (SystemParametersInfoW(SPI_GETHIGHCONTRAST, sizeof(contrast), &contrast, 0))
+        settings->highContrast = contrast.dwFlags & HCF_HIGHCONTRASTON;
+
+    // The accent color UISettings reports, stored by the shell as 0xAABBGGRR
+    DWORD color, size = sizeof(color);
+    if (RegGetValueW(HKEY_CURRENT_USER, L"Software\\Microsoft\\Windows\\DWM", L"AccentColor",
+                     RRF_RT_REG_DWORD, NULL, &color, &size) == ERROR_SUCCESS) {
+        settings->hasAccent = true;
+        settings->accent = (SDL_Color){color & 0xff, color >> 8 & 0xff, color >> 16 & 0xff, 255};
+    }
+}
+#elif defined(__linux__)
+static int watchPortal(void *data) {
+    if (!loadDBus())
+        return 0;
+    void *connection = connectPortal();
+    if (!connection)
+        return 0;
+
+    // Sleep until the bus has something or the app exits
+    int fd;
+    if (!portal.getUnixFd(connection, &fd))
+        fd = -1;
+    struct pollfd fds[2] = {{fd, POLLIN, 0}, {portal.wake, POLLIN, 0}};
+    while (!SDL_GetAtomicInt(&portal.stop) && portal.getIsConnected(connection)) {
+        // Read without blocking, and handle everything that arrived
+        portal.readWrite(connection, 0);
+        void *message;
+        while ((message = portal.popMessage(connection))) {
+            handlePortalMessage(message);
+            portal.unref(message);
+        }
+        if (poll(fds, fd < 0 ? 1 : 2, -1) < 0 && errno != EINTR)
+            break;
+    }
+
+    portal.close(connection);
+    portal.connectionUnref(connection);
+    return 0;
+}
+
+static bool loadDBus(void) {
+    portal.lib = SDL_LoadObject("libdbus-1.so.3");
+    if (!portal.lib)
+        return false;
+    portal.threadsInitDefault = (void *)SDL_LoadFunction(portal.lib, "dbus_threads_init_default");
+    portal.errorInit = (void *)SDL_LoadFunction(portal.lib, "dbus_error_init");
+    portal.errorFree = (void *)SDL_LoadFunction(portal.lib, "dbus_error_free");
+    portal.busGetPrivate = (void *)SDL_LoadFunction(portal.lib, "dbus_bus_get_private");
+    portal.busAddMatch = (void *)SDL_LoadFunction(portal.lib, "dbus_bus_add_match");
+    portal.setExitOnDisconnect = (void *)SDL_LoadFunction(
+        portal.lib, "dbus_connection_set_exit_on_disconnect");
+    portal.getUnixFd = (void *)SDL_LoadFunction(portal.lib, "dbus_connection_get_unix_fd");
+    portal.getIsConnected = (void *)SDL_LoadFunction(portal.lib,
+                                                     "dbus_connection_get_is_connected");
+    portal.readWrite = (void *)SDL_LoadFunction(portal.lib, "dbus_connection_read_write");
+    portal.popMessage = (void *)SDL_LoadFunction(portal.lib, "dbus_connection_pop_message");
+    portal.send = (void *)SDL_LoadFunction(portal.lib, "dbus_connection_send");
+    portal.flush = (void *)SDL_LoadFunction(portal.lib, "dbus_connection_flush");
+    portal.close = (void *)SDL_LoadFunction(portal.lib, "dbus_connection_close");
+    portal.connectionUnref = (void *)SDL_LoadFunction(portal.lib, "dbus_connection_unref");
+    portal.newMethodCall = (void *)SDL_LoadFunction(portal.lib, "dbus_message_new_method_call");
+    portal.appendArgs = (void *)SDL_LoadFunction(portal.lib, "dbus_message_append_args");
+    portal.getType = (void *)SDL_LoadFunction(portal.lib, "dbus_message_get_type");
+    portal.getReplySerial = (void *)SDL_LoadFunction(portal.lib, "dbus_message_get_reply_serial");
+    portal.isSignal = (void *)SDL_LoadFunction(portal.lib, "dbus_message_is_signal");
+    portal.unref = (void *)SDL_LoadFunction(portal.lib, "dbus_message_unref");
+    portal.iterInit = (void *)SDL_LoadFunction(portal.lib, "dbus_message_iter_init");
+    portal.iterGetArgType = (void *)SDL_LoadFunction(portal.lib, "dbus_message_iter_get_arg_type");
+    portal.iterRecurse = (void *)SDL_LoadFunction(portal.lib, "dbus_message_iter_recurse");
+    portal.iterGetBasic = (void *)SDL_LoadFunction(portal.lib, "dbus_message_iter_get_basic");
+    portal.iterNext = (void *)SDL_LoadFunction(portal.lib, "dbus_message_iter_next");
+    return portal.threadsInitDefault && portal.errorInit && portal.errorFree &&
+           portal.busGetPrivate && portal.busAddMatch && portal.setExitOnDisconnect &&
+           portal.getUnixFd && portal.getIsConnected && portal.readWrite && portal.popMessage &&
+           portal.send && portal.flush && portal.close && portal.connectionUnref &&
+           portal.newMethodCall && portal.appendArgs && portal.getType &&
+           portal.getReplySerial && portal.isSignal && portal.unref && portal.iterInit &&
+           portal.iterGetArgType && portal.iterRecurse && portal.iterGetBasic &&
+           portal.iterNext;
+}
+
+static void *connectPortal(void) {
+    // A private connection, which must not take the app down with the bus
+    portal.threadsInitDefault();
+    dbusError error;
+    portal.errorInit(&error);
+    void *connection = portal.busGetPrivate(DBUS_BUS_SESSION, &error);
+    portal.errorFree(&error);
+    if (!connection)
+        return NULL;
+    portal.setExitOnDisconnect(connection, 0);
+
+    // Subscribe before reading, so no change in between is lost. Neither waits for the bus.
+    portal.busAddMatch(connection, "type='signal',interface='org.freedesktop.portal.Settings',"
+                       "member='SettingChanged',arg0='org.freedesktop.appearance'", NULL);
+    const char *space = "org.freedesktop.appearance";
+    const char *keys[2] = {"accent-color", "contrast"};
+    Uint32 *serials[2] = {&portal.accentSerial, &portal.contrastSerial};
+    for (int i = 0; i < 2; i++) {
+        void *message = portal.newMethodCall("org.freedesktop.portal.Desktop",
+                                             "/org/freedesktop/portal/desktop",
+                                             "org.freedesktop.portal.Settings", "Read");
+        if (!message)
+            continue;
+        portal.appendArgs(message, DBUS_TYPE_STRING, &space, DBUS_TYPE_STRING, &keys[i],
+                          DBUS_TYPE_INVALID);
+        portal.send(connection, message, serials[i]);
+        portal.unref(message);
+    }
+    portal.flush(connection);
+    return connection;
+}
+
+static void handlePortalMessage(void *message) {
+    // Replies to the initial reads and change signals, errors of missing keys leave the default
+    dbusIter iter;
+    if (!portal.iterInit(message, &iter))
+        return;
+    const char *key = NULL;
+    if (portal.getType(message) == DBUS_MESSAGE_TYPE_METHOD_RETURN) {
+        Uint32 serial = portal.getReplySerial(message);
+        key = serial == portal.accentSerial ? "accent-color" :
+              serial == portal.contrastSerial ? "contrast" : NULL;
+    } else if (portal.getType(message) == DBUS_MESSAGE_TYPE_SIGNAL &&
+               portal.isSignal(message, "org.freedesktop.portal.Settings", "SettingChanged")) {
+        // The namespace, the key and the value
+        const char *space;
+        if (portal.iterGetArgType(&iter) != DBUS_TYPE_STRING)
+            return;
+        portal.iterGetBasic(&iter, &space);
+        if (SDL_strcmp(space, "org.freedesktop.appearance") != 0 || !portal.iterNext(&iter) ||
+            portal.iterGetArgType(&iter) != DBUS_TYPE_STRING)
+            return;
+        portal.iterGetBasic(&iter, &key);
+        if (!portal.iterNext(&iter))
+            return;
+    }
+    if (!key)
+        return;
+
+    int before = SDL_GetAtomicInt(&portal.settings), after = before;
+    if (SDL_strcmp(key, "accent-color") == 0) {
+        // An accent outside of the unit cube means the user didn't choose one
+        double accent[3];
+        after &= PORTAL_HIGH_CONTRAST;
+        if (readPortalValue(&iter, DBUS_TYPE_DOUBLE, accent, 3) &&
+            accent[0] >= 0 && accent[0] <= 1 && accent[1] >= 0 && accent[1] <= 1 &&
+            accent[2] >= 0 && accent[2] <= 1) {
+            after |= PORTAL_HAS_ACCENT | SDL_lround(accent[0] * 255) << 16 |
+                     SDL_lround(accent[1] * 255) << 8 | SDL_lround(accent[2] * 255);
+        }
+    } else if (SDL_strcmp(key, "contrast") == 0) {
+        // 0 is no preference, 1 is higher contrast
+        Uint32 contrast;
+        if (readPortalValue(&iter, DBUS_TYPE_UINT32, &contrast, 1))
+            after = contrast == 1 ? after | PORTAL_HIGH_CONTRAST : after & ~PORTAL_HIGH_CONTRAST;
+    }
+
+    // Let the main thread derive its palette again
+    if (after != before) {
+        SDL_SetAtomicInt(&portal.settings, after);
+        SDL_Event event = {.type = SDL_EVENT_SYSTEM_THEME_CHANGED};
+        event.common.timestamp = SDL_GetTicksNS();
+        SDL_PushEvent(&event);
+    }
+}
+
+static bool readPortalValue(dbusIter *iter, int type, void *values, int count) {
+    /* Reads a single value or a structure of count values of the same type. Read wraps it in a
+     * variant, older portals in a second one. */
+    dbusIter sub;
+    while (portal.iterGetArgType(iter) == DBUS_TYPE_VARIANT) {
+        portal.iterRecurse(iter, &sub);
+        *iter = sub;
+    }
+    if (count > 1 && portal.iterGetArgType(iter) == DBUS_TYPE_STRUCT) {
+        portal.iterRecurse(iter, &sub);
+        *iter = sub;
+    }
+    size_t size = type == DBUS_TYPE_DOUBLE ? sizeof(double) : sizeof(Uint32);
+    int i = 0;
+    while (i < count && portal.iterGetArgType(iter) == type) {
+        portal.iterGetBasic(iter, (char *)values + i * size);
+        i++;
+        portal.iterNext(iter);
+    }
+    return i == count;
+}
+#endif
+
+static bool readMockAppearance(void *data, appearance *settings) {
+    *settings = *(const appearance *)data;
+    return true;
+}
+
+static void computePalette(const palette *base, const appearance *settings, palette *colors) {
+    SDL_Color white = {255, 255, 255, 255}, black = {0, 0, 0, 255};
+    SDL_Color paper = settings->dark ? black : white, ink = settings->dark ? white : black;
+    *colors = *base;
+
+    if (settings->highContrast) {
+        // Plain surfaces with the accent, or the ink, as a clearly visible border
+        colors->titleBar = paper;
+        colors->background = paper;
+        colors->border = ensureContrast(settings->hasAccent ? settings->accent : ink, paper, 3);
+        colors->text = ink;
+        return;
+    }
+
+    // Tint the surfaces with the accent, the border most
+    if (settings->hasAccent) {
+        colors->border = mixColors(base->border, settings->accent, 0.5f);
+        colors->titleBar = mixColors(base->titleBar, settings->accent, 0.12f);
+        colors->background = mixColors(base->background, settings->accent, 0.04f);
+    }
+    colors->text = ensureContrast(base->text, colors->titleBar, 4.5f);
+}
+
+static SDL_Color ensureContrast(SDL_Color color, SDL_Color against, float ratio) {
+    // Move the color towards black or white, whichever stands out more against the other color
+    SDL_Color white = {255, 255, 255, 255}, black = {0, 0, 0, 255};
+    SDL_Color target = getContrastRatio(white, against) > getContrastRatio(black, against) ?
+                       white : black;
+    SDL_Color result = color;
+    for (int step = 1; step <= 10 && getContrastRatio(result, against) < ratio; step++)
+        result = mixColors(color, target, step / 10.0f);
+    return result;
+}
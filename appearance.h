@@ -0,0 +1,53 @@
+/* 
+  A fully functional SDL3 window with a custom-drawn non-client area and shadow 
+  Copyright (C) 2025 fischflocke
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef APPEARANCE_H
+#define APPEARANCE_H
+
+// Standard includes
+#include <stdbool.h>
+
+// SDL3 includes
+#include <SDL3/SDL.h>
+
+// Local includes
+#include "palette.h"
+
+// What the system's settings say the chrome should look like
+typedef struct {
+    bool dark;
+    bool hasAccent;
+    SDL_Color accent;
+    bool highContrast;
+} appearance;
+
+// Where the settings come from, the system or a mock for testing without one
+typedef struct {
+    bool (*read)(void *data, appearance *settings);
+    void *data;
+} appearanceSource;
+
+appearanceSource getSystemAppearance(void);
+bool watchSystemAppearance(void);
+void unwatchSystemAppearance(void);
+appearanceSource getMockAppearance(const char *spec);
+bool readAppearance(const appearanceSource *source, appearance *settings);
+void derivePalette(const palette *base, const appearance *settings, palette *colors);
+bool checkPalettes(void);
+
+#endif
@@ -0,0 +1,208 @@
+/* 
+  A fully functional SDL3 window with a custom-drawn non-client area and shadow 
+  Copyright (C) 2025 fischflocke
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Standard includes
+#include <math.h>
+#include <stdbool.h>
+
+// SDL3 includes
+#include <SDL3/SDL.h>
+
+// Local includes
+#include "caption.h"
+#include "layout.h"
+#include "renderstate.h"
+
+// Samples per pixel and axis when rasterizing the icons
+#define ICON_SAMPLES 4
+// Opacity of a button's background while hovered and while pressed
+#define HOVER_ALPHA 0.12f
+#define PRESS_ALPHA 0.24f
+
+// Cells of the icon atlas, from left to right
+typedef enum {
+    ICON_BACKGROUND,
+    ICON_MINIMIZE,
+    ICON_MAXIMIZE,
+    ICON_RESTORE,
+    ICON_CLOSE,
+    ICON_COUNT
+} iconCell;
+
+static float getIconCoverage(iconCell cell, float x, float y, float size, float stroke);
+static float getSegmentDistance(float x, float y, const float *segment);
+static captionButton findButton(const windowLayout *layout, const SDL_Point *pos,
+                                captionButton current);
+static void getButtonStates(int *states);
+static Uint32 getChangedButtons(const int *before);
+
+// Glyphs as stroked segments from x0, y0 to x1, y1 within a unit square
+static const struct {
+    int count;
+    float segments[6][4];
+} glyphs[ICON_COUNT] = {
+    [ICON_MINIMIZE] = {1, {{0, 1, 1, 1}}},
+    [ICON_MAXIMIZE] = {4, {{0, 0, 1, 0}, {1, 0, 1, 1}, {1, 1, 0, 1}, {0, 1, 0, 0}}},
+    // A window in front of another one
+    [ICON_RESTORE] = {6, {{0, 0.25f, 0.75f, 0.25f}, {0.75f, 0.25f, 0.75f, 1}, {0.75f, 1, 0, 1},
+                          {0, 1, 0, 0.25f}, {0.25f, 0, 1, 0}, {1, 0, 1, 0.75f}}},
+    [ICON_CLOSE] = {2, {{0, 0, 1, 1}, {1, 0, 0, 1}}}
+};
+
+/* The pointer hovers a button once it's inside of it, but only leaves it once it's clearly
+ * outside, so a pointer resting on the edge doesn't flicker. A press is only released over the
+ * button it started on. */
+static struct {
+    captionButton hovered;
+    captionButton pressed;
+} caption = {CAPTION_NONE, CAPTION_NONE};
+
+SDL_Surface *createCaptionIcons(int size, int stroke) {
+    /* White coverage masks, tinted when drawn. They're rendered once per scale, so they are
+     * supersampled instead of drawn with lines that depend on the renderer. */
+    SDL_Surface *icons = SDL_CreateSurface(ICON_COUNT * size, size, SDL_PIXELFORMAT_RGBA32);
+    if (!icons)
+        return NULL;
+
+    for (int cell = 0; cell < ICON_COUNT; cell++) {
+        for (int y = 0; y < size; y++) {
+            Uint8 *row = (Uint8 *)icons->pixels + y * icons->pitch + cell * size * 4;
+            for (int x = 0; x < size; x++) {
+                float coverage = 0;
+                for (int sy = 0; sy < ICON_SAMPLES; sy++) {
+                    for (int sx = 0; sx < ICON_SAMPLES; sx++) {
+                        coverage += getIconCoverage(cell, x + (sx + 0.5f) / ICON_SAMPLES,
+                                                    y + (sy + 0.5f) / ICON_SAMPLES, size, stroke);
+                    }
+                }
+                Uint8 *p = row + x * 4;
+                p[0] = p[1] = p[2] = 255;
+                p[3] = roundf(255 * coverage / (ICON_SAMPLES * ICON_SAMPLES));
+            }
+        }
+    }
+    return icons;
+}
+
+Uint32 moveCaptionPointer(const windowLayout *layout, const SDL_Point *pos) {
+    int before[CAPTION_BUTTONS];
+    getButtonStates(before);
+    caption.hovered = findButton(layout, pos, caption.hovered);
+    return getChangedButtons(before);
+}
+
+Uint32 pressCaptionButton(const windowLayout *layout, const SDL_Point *pos) {
+    int before[CAPTION_BUTTONS];
+    getButtonStates(before);
+    caption.hovered = findButton(layout, pos, caption.hovered);
+    caption.pressed = caption.hovered;
+    return getChangedButtons(before);
+}
+
+Uint32 releaseCaptionButton(const windowLayout *layout, const SDL_Point *pos,
+                            captionButton *clicked) {
+    int before[CAPTION_BUTTONS];
+    getButtonStates(before);
+    caption.hovered = findButton(layout, pos, caption.hovered);
+    *clicked = caption.pressed != CAPTION_NONE && caption.pressed == caption.hovered ?
+               caption.pressed : CAPTION_NONE;
+    caption.pressed = CAPTION_NONE;
+    return getChangedButtons(before);
+}
+
+Uint32 leaveCaption(void) {
+    int before[CAPTION_BUTTONS];
+    getButtonStates(before);
+    caption.hovered = CAPTION_NONE;
+    return getChangedButtons(before);
+}
+
+void drawCaptionButton(SDL_Renderer *renderer, SDL_Texture *icons, const SDL_Rect *rect,
+                       captionButton button, bool maximized, SDL_Color text) {
+    if (!icons)
+        return;
+    float size = rect->h;
+    SDL_FRect dest = {rect->x, rect->y, rect->w, rect->h};
+    SDL_FRect src = {0, 0, size, size};
+
+    // Background while hovered or pressed
+    if (caption.hovered == button) {
+        float alpha = caption.pressed == button ? PRESS_ALPHA : HOVER_ALPHA;
+        setTextureTint(icons, text.r, text.g, text.b, alpha * text.a / 255.0f);
+        src.x = ICON_BACKGROUND * size;
+        SDL_RenderTexture(renderer, icons, &src, &dest);
+    }
+
+    // Glyph in the text color, the maximize button restores if the window is maximized
+    iconCell cells[CAPTION_BUTTONS] = {ICON_MINIMIZE, maximized ? ICON_RESTORE : ICON_MAXIMIZE,
+                                       ICON_CLOSE};
+    setTextureTint(icons, text.r, text.g, text.b, text.a / 255.0f);
+    src.x = cells[button] * size;
+    SDL_RenderTexture(renderer, icons, &src, &dest);
+}
+
+static float getIconCoverage(iconCell cell, float x, float y, float size, float stroke) {
+    float c = size / 2;
+    if (cell == ICON_BACKGROUND)
+        return (x - c) * (x - c) + (y - c) * (y - c) <= c * c;
+
+    // Place the glyph's segments in a square around the center, odd strokes on pixel centers
+    float g = roundf(size * 0.36f), l = floorf(c - g / 2) + fmodf(stroke, 2) / 2;
+    for (int i = 0; i < glyphs[cell].count; i++) {
+        const float *unit = glyphs[cell].segments[i];
+        float segment[4] = {l + unit[0] * g, l + unit[1] * g, l + unit[2] * g, l + unit[3] * g};
+        if (getSegmentDistance(x, y, segment) <= stroke / 2)
+            return 1;
+    }
+    return 0;
+}
+
+static float getSegmentDistance(float x, float y, const float *segment) {
+    // Distance to the closest point of the segment from x0, y0 to x1, y1
+    float dx = segment[2] - segment[0], dy = segment[3] - segment[1];
+    float t = ((x - segment[0]) * dx + (y - segment[1]) * dy) / (dx * dx + dy * dy);
+    t = SDL_clamp(t, 0, 1);
+    float px = segment[0] + t * dx - x, py = segment[1] + t * dy - y;
+    return sqrtf(px * px + py * py);
+}
+
+static captionButton findButton(const windowLayout *layout, const SDL_Point *pos,
+                                captionButton current) {
+    // Stay on the current button until the pointer is past the edge tolerance
+    if (current != CAPTION_NONE &&
+        getCaptionButtonAt(layout, pos, layout->metrics.edgeTol) == current)
+        return current;
+    return getCaptionButtonAt(layout, pos, 0);
+}
+
+static void getButtonStates(int *states) {
+    // Normal, hovered or pressed, a pressed button looks normal while the pointer is off it
+    for (int i = 0; i < CAPTION_BUTTONS; i++)
+        states[i] = caption.hovered == i ? 1 + (caption.pressed == i) : 0;
+}
+
+static Uint32 getChangedButtons(const int *before) {
+    int after[CAPTION_BUTTONS];
+    getButtonStates(after);
+    Uint32 changed = 0;
+    for (int i = 0; i < CAPTION_BUTTONS; i++) {
+        if (after[i] != before[i])
+            changed |= 1u << i;
+    }
+    return changed;
+}
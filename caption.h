@@ -0,0 +1,40 @@
+/* 
+  A fully functional SDL3 window with a custom-drawn non-client area and shadow 
+  Copyright (C) 2025 fischflocke
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef CAPTION_H
+#define CAPTION_H
+
+// Standard includes
+#include <stdbool.h>
+
+// SDL3 includes
+#include <SDL3/SDL.h>
+
+// Local includes
+#include "layout.h"
+
+SDL_Surface *createCaptionIcons(int size, int stroke);
+Uint32 moveCaptionPointer(const windowLayout *layout, const SDL_Point *pos);
+Uint32 pressCaptionButton(const windowLayout *layout, const SDL_Point *pos);
+Uint32 releaseCaptionButton(const windowLayout *layout, const SDL_Point *pos,
+                            captionButton *clicked);
+Uint32 leaveCaption(void);
+void drawCaptionButton(SDL_Renderer *renderer, SDL_Texture *icons, const SDL_Rect *rect,
+                       captionButton button, bool maximized, SDL_Color text);
+
+#endif
@@ -0,0 +1,285 @@
+/* 
+  A fully functional SDL3 window with a custom-drawn non-client area and shadow 
+  Copyright (C) 2025 fischflocke
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Standard includes
+#include <stdbool.h>
+
+// SDL3 includes
+#include <SDL3/SDL.h>
+#include <SDL3_image/SDL_image.h>
+
+// Local includes
+#include "alloc.h"
+#include "capture.h"
+#include "trace.h"
+
+// Buffers for single captures, a capture is dropped if all of them are still being encoded
+#define CAPTURE_BUFFERS 2
+// Longest path of a capture file
+#define CAPTURE_PATH 256
+
+typedef enum {
+    SLOT_FREE,
+    // Holding one of the last frames, or waiting to be encoded
+    SLOT_RING,
+    SLOT_QUEUED
+} slotState;
+
+typedef struct {
+    slotState state;
+    void *pixels;
+    size_t capacity;
+    int w;
+    int h;
+    // Whether the buffer holds a frame, ring buffers are allocated before they record one
+    bool stored;
+    char path[CAPTURE_PATH];
+} captureSlot;
+
+static void freeCapture(void);
+static captureSlot *getFreeSlot(void);
+static bool storeFrame(SDL_Renderer *renderer, captureSlot *slot);
+static bool reserveSlot(captureSlot *slot, int w, int h);
+static int encodeCaptures(void *data);
+
+/* Frames are read back and copied into preallocated buffers on the main thread and encoded as
+ * PNG by a worker, so the render loop never waits for an encode. The buffers are the ring of the
+ * last frames, if enabled, followed by the ones for single captures. Slots only change state with
+ * the mutex held, the worker owns queued ones. */
+static struct {
+    captureSlot *slots;
+    int ringFrames;
+    int ringNext;
+    // When the ring may record its next frame, and how many it has recorded
+    Uint64 ringDue;
+    Uint64 ringRecorded;
+    // Single capture requested for the next frame, with an empty path for an automatic one
+    bool requested;
+    char requestedPath[CAPTURE_PATH];
+    SDL_Mutex *mutex;
+    SDL_Condition *queued;
+    SDL_Thread *worker;
+    bool quit;
+} capture;
+
+bool initCapture(int ringFrames, int w, int h) {
+    capture.ringFrames = ringFrames;
+    capture.slots = SDL_calloc(ringFrames + CAPTURE_BUFFERS, sizeof(captureSlot));
+    capture.mutex = SDL_CreateMutex();
+    capture.queued = SDL_CreateCondition();
+    if (!capture.slots || !capture.mutex || !capture.queued) {
+        freeCapture();
+        return false;
+    }
+
+    // Allocate the ring up front at the window's size, so recording only grows it on resizes
+    for (int i = 0; i < ringFrames; i++) {
+        if (!reserveSlot(&capture.slots[i], w, h)) {
+            freeCapture();
+            return false;
+        }
+        capture.slots[i].state = SLOT_RING;
+    }
+
+    capture.worker = SDL_CreateThread(encodeCaptures, "capture", NULL);
+    if (!capture.worker) {
+        freeCapture();
+        return false;
+    }
+    return true;
+}
+
+void quitCapture(void) {
+    if (!capture.worker)
+        return;
+
+    // Finish the queued captures
+    SDL_LockMutex(capture.mutex);
+    capture.quit = true;
+    SDL_SignalCondition(capture.queued);
+    SDL_UnlockMutex(capture.mutex);
+    SDL_WaitThread(capture.worker, NULL);
+    capture.worker = NULL;
+    freeCapture();
+}
+
+static void freeCapture(void) {
+    // Also unwinds a partial setup, where some of these are missing
+    if (capture.slots) {
+        for (int i = 0; i < capture.ringFrames + CAPTURE_BUFFERS; i++)
+            SDL_free(capture.slots[i].pixels);
+        SDL_free(capture.slots);
+    }
+    if (capture.queued)
+        SDL_DestroyCondition(capture.queued);
+    if (capture.mutex)
+        SDL_DestroyMutex(capture.mutex);
+    SDL_zero(capture);
+}
+
+void requestCapture(const char *path) {
+    // Without a ring, the buffers and the worker are only set up for the first capture
+    if (!capture.worker && !initCapture(0, 0, 0)) {
+        SDL_Log("Failed to set up capturing: %s", SDL_GetError());
+        return;
+    }
+    capture.requested = true;
+    SDL_strlcpy(capture.requestedPath, path ? path : "", sizeof(capture.requestedPath));
+}
+
+void requestRingDump(void) {
+    if (!capture.worker)
+        return;
+
+    // Queue the recorded frames from the oldest, recording pauses until they're encoded
+    Uint64 now = SDL_GetTicks();
+    SDL_LockMutex(capture.mutex);
+    for (int i = 0; i < capture.ringFrames; i++) {
+        int index = (capture.ringNext + i) % capture.ringFrames;
+        captureSlot *slot = &capture.slots[index];
+        if (slot->state != SLOT_RING || !slot->stored)
+            continue;
+        SDL_snprintf(slot->path, sizeof(slot->path), "ring-%" SDL_PRIu64 "-%02d.png", now, i);
+        slot->state = SLOT_QUEUED;
+    }
+    SDL_SignalCondition(capture.queued);
+    SDL_UnlockMutex(capture.mutex);
+}
+
+void captureFrame(SDL_Renderer *renderer) {
+    if (!capture.worker || (!capture.requested && !capture.ringFrames))
+        return;
+    Uint64 start = traceNow();
+    allocPhase phase = setAllocPhase(ALLOC_CAPTURE);
+
+    // A single capture
+    if (capture.requested) {
+        capture.requested = false;
+        captureSlot *slot = getFreeSlot();
+        if (!slot) {
+            SDL_Log("Dropped a capture, the previous ones are still being encoded");
+        } else if (storeFrame(renderer, slot)) {
+            if (*capture.requestedPath)
+                SDL_strlcpy(slot->path, capture.requestedPath, sizeof(slot->path));
+            else
+                SDL_snprintf(slot->path, sizeof(slot->path), "capture-%" SDL_PRIu64 ".png",
+                             SDL_GetTicks());
+            SDL_LockMutex(capture.mutex);
+            slot->state = SLOT_QUEUED;
+            SDL_SignalCondition(capture.queued);
+            SDL_UnlockMutex(capture.mutex);
+        }
+    }
+
+    // The ring of the last frames, unless it's being dumped
+    if (capture.ringFrames && start >= capture.ringDue) {
+        captureSlot *slot = &capture.slots[capture.ringNext];
+        SDL_LockMutex(capture.mutex);
+        bool recording = slot->state == SLOT_RING;
+        SDL_UnlockMutex(capture.mutex);
+        if (recording && storeFrame(renderer, slot)) {
+            capture.ringNext = (capture.ringNext + 1) % capture.ringFrames;
+            capture.ringDue = start + CAPTURE_RING_INTERVAL;
+            capture.ringRecorded++;
+        }
+    }
+
+    setAllocPhase(phase);
+    traceSpan("capture", start, traceNow());
+}
+
+Uint64 getRingFrameCount(void) {
+    return capture.ringRecorded;
+}
+
+static captureSlot *getFreeSlot(void) {
+    captureSlot *slot = NULL;
+    SDL_LockMutex(capture.mutex);
+    for (int i = capture.ringFrames; i < capture.ringFrames + CAPTURE_BUFFERS && !slot; i++) {
+        if (capture.slots[i].state == SLOT_FREE)
+            slot = &capture.slots[i];
+    }
+    SDL_UnlockMutex(capture.mutex);
+    return slot;
+}
+
+static bool storeFrame(SDL_Renderer *renderer, captureSlot *slot) {
+    /* Read back what has been drawn so far, which has to happen before presenting. SDL has no way
+     * to read into a given buffer, so this allocates a surface every time. */
+    SDL_Surface *frame = SDL_RenderReadPixels(renderer, NULL);
+    if (!frame)
+        return false;
+
+    // Keep it in a fixed format, so the buffer can be reused for any renderer
+    bool stored = reserveSlot(slot, frame->w, frame->h) &&
+                  SDL_ConvertPixels(frame->w, frame->h, frame->format, frame->pixels, frame->pitch,
+                                    SDL_PIXELFORMAT_ARGB8888, slot->pixels, frame->w * 4);
+    SDL_DestroySurface(frame);
+    slot->stored = stored;
+    return stored;
+}
+
+static bool reserveSlot(captureSlot *slot, int w, int h) {
+    // Buffers only grow, so a ring that has seen the largest size no longer allocates
+    size_t size = (size_t)w * h * 4;
+    if (size > slot->capacity) {
+        void *pixels = SDL_realloc(slot->pixels, size);
+        if (!pixels)
+            return false;
+        slot->pixels = pixels;
+        slot->capacity = size;
+    }
+    slot->w = w;
+    slot->h = h;
+    return true;
+}
+
+static int encodeCaptures(void *data) {
+    SDL_LockMutex(capture.mutex);
+    for (;;) {
+        // Find the next queued capture, or wait for one
+        captureSlot *slot = NULL;
+        int count = capture.ringFrames + CAPTURE_BUFFERS;
+        for (int i = 0; i < count && !slot; i++) {
+            if (capture.slots[i].state == SLOT_QUEUED)
+                slot = &capture.slots[i];
+        }
+        if (!slot) {
+            if (capture.quit)
+                break;
+            SDL_WaitCondition(capture.queued, capture.mutex);
+            continue;
+        }
+
+        // Encode without holding the lock, nobody else touches a queued slot
+        SDL_UnlockMutex(capture.mutex);
+        Uint64 start = traceNow();
+        SDL_Surface *surface = SDL_CreateSurfaceFrom(slot->w, slot->h, SDL_PIXELFORMAT_ARGB8888,
+                                                     slot->pixels, slot->w * 4);
+        if (!surface || !IMG_SavePNG_IO(surface, SDL_IOFromFile(slot->path, "wb"), true))
+            SDL_Log("Failed to save %s: %s", slot->path, SDL_GetError());
+        SDL_DestroySurface(surface);
+        traceSpan("capture encode", start, traceNow());
+        SDL_LockMutex(capture.mutex);
+
+        // Ring slots go back to recording
+        slot->state = slot < capture.slots + capture.ringFrames ? SLOT_RING : SLOT_FREE;
+    }
+    SDL_UnlockMutex(capture.mutex);
+    return 0;
+}
@@ -0,0 +1,371 @@
+/* 
+  A fully functional SDL3 window with a custom-drawn non-client area and shadow 
+  Copyright (C) 2025 fischflocke
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Standard includes
+#include <math.h>
+#include <stdbool.h>
+
+// SDL3 includes
+#include <SDL3/SDL.h>
+
+// Local includes
+#include "alloc.h"
+#include "capture.h"
+#include "checks.h"
+#include "cursor.h"
+#include "pacing.h"
+#include "rendertune.h"
+#include "stats.h"
+#include "titletext.h"
+#include "trace.h"
+
+// Timed frames per benchmark run
+#define BENCH_FRAMES 200
+
+// A benchmark run of the chrome, and the renderer calls it took
+typedef struct {
+    const checkedApp *app;
+    bool rounded;
+    Uint64 draws;
+} chromeRun;
+
+static bool checkLoopScenario(const checkedApp *app, const char *name,
+                              const scriptedEvent *events, int count, Uint64 end,
+                              Uint64 minFrames, Uint64 maxFrames, Uint64 layouts, bool partial);
+static Uint64 countFrameAllocs(void);
+static void drawWindowFrame(void *data);
+static void drawChromeFrame(void *data);
+
+bool checkSteadyAllocs(const checkedApp *app) {
+    // Let caches and the renderer's command queue grow to their final size first
+    for (int i = 0; i < 3; i++) {
+        app->updateLayout();
+        app->drawWindow(NULL);
+    }
+
+    // Redraw and lay out again at the same size, as a resize that ends where it started does
+    Uint64 before = countFrameAllocs();
+    for (int i = 0; i < 100; i++) {
+        app->updateLayout();
+        app->drawWindow(NULL);
+    }
+    Uint64 allocated = countFrameAllocs() - before;
+
+    if (allocated)
+        SDL_Log("Steady state allocated %" SDL_PRIu64 " times in 100 frames", allocated);
+    else
+        SDL_Log("Steady state does not allocate");
+
+    /* Animate the shadow's opacity for a second of frames at 60 Hz, which only changes the
+     * tint and must not rebuild anything */
+    float opacity = app->shadowOpacity;
+    before = countFrameAllocs();
+    for (int i = 0; i < 60; i++) {
+        app->setShadowOpacity(opacity * (1 + sinf(2 * (float)M_PI * i / 60)) / 2);
+        app->drawWindow(NULL);
+    }
+    Uint64 animated = countFrameAllocs() - before;
+    app->setShadowOpacity(opacity);
+
+    if (animated)
+        SDL_Log("Shadow opacity animation allocated %" SDL_PRIu64 " times in 60 frames", animated);
+    else
+        SDL_Log("Shadow opacity animation does not allocate");
+
+    /* The same with the capture ring, set up just for the check without --capture-ring. Its
+     * readbacks allocate in their own phase, and only as often as the ring is throttled to. */
+    bool ownRing = !app->captureRing;
+    if (ownRing && !initCapture(4, app->layout->window.w, app->layout->window.h)) {
+        SDL_Log("Failed to set up the capture ring: %s", SDL_GetError());
+        return false;
+    }
+    Uint64 start = traceNow(), recorded = getRingFrameCount();
+    Uint64 captures = getAllocCount(ALLOC_CAPTURE);
+    before = countFrameAllocs();
+    for (int i = 0; i < 100; i++) {
+        app->updateLayout();
+        app->drawWindow(NULL);
+    }
+    Uint64 ringAllocated = countFrameAllocs() - before;
+    captures = getAllocCount(ALLOC_CAPTURE) - captures;
+    recorded = getRingFrameCount() - recorded;
+    Uint64 allowed = (traceNow() - start) / CAPTURE_RING_INTERVAL + 1;
+    if (ownRing)
+        quitCapture();
+
+    SDL_Log("With the capture ring, 100 frames allocated %" SDL_PRIu64 " times, and recording %"
+            SDL_PRIu64 " of them %" SDL_PRIu64 " times", ringAllocated, recorded, captures);
+    bool ring = ringAllocated == 0 && recorded <= allowed && (captures == 0 || recorded > 0);
+    return allocated == 0 && animated == 0 && ring;
+}
+
+bool checkMainLoop(const checkedApp *app) {
+    // Events of the scenarios, which happen to this window
+    SDL_WindowID id = SDL_GetWindowID(app->window);
+    int w, h;
+    SDL_GetWindowSizeInPixels(app->window, &w, &h);
+    scriptedEvent events[100];
+    bool passed = true;
+    Uint64 rate = ceilf(getRefreshRate());
+
+    // Nothing happens, which must not draw anything
+    passed &= checkLoopScenario(app, "idle", NULL, 0, 10 * SDL_NS_PER_SECOND, 0, 0, 0,
+                                     false);
+
+    // A burst of resizes is laid out every time, but drawn only once
+    for (int i = 0; i < 20; i++) {
+        events[i] = (scriptedEvent){0, {.window = {SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED, 0, 0, id,
+                                                   w + i, h}}};
+    }
+    passed &= checkLoopScenario(app, "resize burst", events, 20, SDL_NS_PER_SECOND, 1, 1, 20,
+                                     false);
+
+    // Exposes are coalesced the same way
+    for (int i = 0; i < 5; i++)
+        events[i] = (scriptedEvent){0, {.window = {SDL_EVENT_WINDOW_EXPOSED, 0, 0, id}}};
+    passed &= checkLoopScenario(app, "expose burst", events, 5, SDL_NS_PER_SECOND, 1, 1, 0,
+                                     false);
+
+    // A theme change without a fade is one frame, with one a frame per refresh of the fade
+    events[0] = (scriptedEvent){0, {.type = SDL_EVENT_SYSTEM_THEME_CHANGED}};
+    app->setThemeFade(0);
+    passed &= checkLoopScenario(app, "theme change", events, 1, SDL_NS_PER_SECOND, 1, 1, 0,
+                                     false);
+    app->setThemeFade(200 * SDL_NS_PER_MS);
+    passed &= checkLoopScenario(app, "theme fade", events, 1, SDL_NS_PER_SECOND, 2,
+                                     rate / 5 + 3, 0, false);
+    app->setThemeFade(app->themeFade);
+
+    /* The pointer crossing the title bar only redraws the buttons it enters and leaves, at most
+     * once per refresh */
+    const SDL_Rect *bar = &app->layout->titleBar;
+    for (int i = 0; i < 100; i++) {
+        float x = (bar->x + bar->w * i / 99.0f) / app->layout->scale;
+        float y = (bar->y + bar->h / 2) / app->layout->scale;
+        events[i] = (scriptedEvent){i * 10 * SDL_NS_PER_MS,
+                                    {.motion = {.type = SDL_EVENT_MOUSE_MOTION, .windowID = id,
+                                                .x = x, .y = y}}};
+    }
+    Uint64 switches = getCursorSwitches();
+    passed &= checkLoopScenario(app, "caption hover", events, 100, 2 * SDL_NS_PER_SECOND, 1,
+                                     2 * CAPTION_BUTTONS, 0, true);
+
+    // The cursor is only set when it changes, between the buttons and the rest of the title bar
+    switches = getCursorSwitches() - switches;
+    SDL_Log("Caption hover switched the cursor %" SDL_PRIu64 " times, %" SDL_PRIu64
+            " cursors were created on demand", switches, getCursorMisses());
+    passed &= switches <= 2 * CAPTION_BUTTONS + 1 && getCursorMisses() == 0;
+
+    // A resize every 10 ms for a second is drawn at most once per refresh
+    for (int i = 0; i < 100; i++) {
+        events[i] = (scriptedEvent){i * 10 * SDL_NS_PER_MS,
+                                    {.window = {SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED, 0, 0, id,
+                                                w - i, h}}};
+    }
+    passed &= checkLoopScenario(app, "resize drag", events, 100, 2 * SDL_NS_PER_SECOND, rate / 2,
+                                     rate + 1, 100, false);
+
+    /* The same while the system holds the main loop in its size loop, which sends an expose
+     * after each resize. Only the watch can draw then, once per expose. */
+    for (int i = 0; i < 50; i++) {
+        Uint64 time = i * 20 * SDL_NS_PER_MS;
+        events[2 * i] = (scriptedEvent){time,
+                                        {.window = {SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED, 0, 0,
+                                                    id, w - i, h}}, true};
+        events[2 * i + 1] = (scriptedEvent){time,
+                                            {.window = {SDL_EVENT_WINDOW_EXPOSED, 0, 0, id, 1}},
+                                            true};
+    }
+    passed &= checkLoopScenario(app, "live resize", events, 100, 2 * SDL_NS_PER_SECOND, 50, 50, 50,
+                                     false);
+
+    // Leave the window at its size
+    app->updateLayout();
+    return passed;
+}
+
+static bool checkLoopScenario(const checkedApp *app, const char *name,
+                              const scriptedEvent *events, int count, Uint64 end,
+                              Uint64 minFrames, Uint64 maxFrames, Uint64 layouts, bool partial) {
+    /* Start on the virtual clock right after a frame, so the scenario doesn't depend on where
+     * between two vblanks the real clock happened to be */
+    eventSource source = startScript(events, count, end, app->watchLiveResize);
+    app->redraw();
+    Uint64 frames = getFrameCount(), laidOut = getLayoutCount();
+    Uint64 partialFrames = getPartialFrameCount();
+    app->runMainLoop(&source);
+    frames = getFrameCount() - frames;
+    laidOut = getLayoutCount() - laidOut;
+    partialFrames = getPartialFrameCount() - partialFrames;
+    stopScript();
+
+    // Partial scenarios only draw one full frame, which refreshes the copy for the others
+    bool passed = frames >= minFrames && frames <= maxFrames && laidOut == layouts &&
+                  (!partial || partialFrames + 1 >= frames);
+    SDL_Log("%s %s: %" SDL_PRIu64 " frames, %" SDL_PRIu64 " layouts", passed ? "Passed" : "Failed",
+            name, frames, laidOut);
+    return passed;
+}
+
+
+bool checkShadow(const shadowGeometry *geometry, timeImageShadowFunc timeImageShadow) {
+    /* Compare the analytic shadow with a brute force blur of the rounded rect for a few
+     * geometries at common scales. Blurred shadows must match within 4/255 everywhere. Without
+     * blur only the antialiasing of the arc can differ, which is allowed 16/255 in the corners. */
+    const shadowGeometry geometries[] = {
+        *geometry, {20, -4, 0, 0}, {20, 0, 0, 4}, {6, 0, 0, 0}, {40, 8, -6, 10}, {0, 2, 0, 0}
+    };
+    const float scales[] = {1, 1.25f, 1.5f, 2, 3};
+
+    int failures = 0;
+    for (size_t i = 0; i < SDL_arraysize(geometries); i++) {
+        for (size_t j = 0; j < SDL_arraysize(scales); j++) {
+            float scale = scales[j];
+            shadowGeometry scaled = {
+                geometries[i].radius * scale, geometries[i].spread * scale,
+                geometries[i].offsetX * scale, geometries[i].offsetY * scale
+            };
+            int radius = getLayoutMetrics(scale).radius;
+            float edgeError, cornerError;
+            if (!measureShadowError(&scaled, radius, &edgeError, &cornerError)) {
+                SDL_Log("Shadow check failed: %s", SDL_GetError());
+                return false;
+            }
+
+            float cornerTolerance = scaled.radius > 0 ? 4 / 255.0f : 16 / 255.0f;
+            if (edgeError > 4 / 255.0f || cornerError > cornerTolerance) {
+                SDL_Log("Shadow check failed: radius %.1f, spread %.1f, offset %.1f,%.1f, scale "
+                        "%.2f, edge error %.4f, corner error %.4f", geometries[i].radius,
+                        geometries[i].spread, geometries[i].offsetX, geometries[i].offsetY, scale,
+                        edgeError, cornerError);
+                failures++;
+            }
+        }
+    }
+
+    /* Time both ways of getting the shadow's pixels for every scale: the analytic atlas, and
+     * decoding the images once plus rounding their corner per scale */
+    Uint64 start = SDL_GetTicksNS();
+    for (size_t j = 0; j < SDL_arraysize(scales); j++) {
+        shadowGeometry scaled = {
+            geometry->radius * scales[j], geometry->spread * scales[j],
+            geometry->offsetX * scales[j], geometry->offsetY * scales[j]
+        };
+        shadowAtlas atlas;
+        SDL_DestroySurface(createShadowAtlas(&scaled, getLayoutMetrics(scales[j]).radius, &atlas));
+    }
+    Uint64 analytic = SDL_GetTicksNS() - start;
+
+    Uint64 decode = 0, corners = 0;
+    if (!timeImageShadow(scales, SDL_arraysize(scales), &decode, &corners)) {
+        SDL_Log("Shadow check failed: %s", SDL_GetError());
+        failures++;
+    }
+
+    SDL_Log("Shadow check: %d failures; %zu scales take %.2f ms analytic, %.2f ms with images "
+            "(%.2f ms decode, %.2f ms corners)", failures, SDL_arraysize(scales),
+            analytic / 1e6, (decode + corners) / 1e6, decode / 1e6, corners / 1e6);
+    return failures == 0;
+}
+
+void benchEdgeToEdge(const checkedApp *app) {
+    // Unpaced, so the time is spent drawing instead of waiting for vblanks
+    SDL_SetRenderVSync(app->renderer, SDL_RENDERER_VSYNC_DISABLED);
+    Uint64 times[2];
+    for (int mode = 0; mode < 2; mode++) {
+        app->setEdgeToEdge(mode);
+        times[mode] = timeFrames(app->renderer, BENCH_FRAMES, drawWindowFrame, (void *)app);
+    }
+
+    // The floating frame clears and blends the whole window, the edge-to-edge one only fills it
+    int w = app->layout->window.w, h = app->layout->window.h;
+    SDL_Log("%dx%d floating: %.3f ms per frame, edge to edge: %.3f ms per frame, %.0f%% less",
+            w, h, times[0] / (BENCH_FRAMES * 1e6), times[1] / (BENCH_FRAMES * 1e6),
+            times[0] ? 100.0 * ((double)times[0] - times[1]) / times[0] : 0.0);
+
+    app->setEdgeToEdge(app->edgeToEdge);
+    initFramePacing(app->renderer, app->window, app->vsync);
+}
+
+void benchRoundedChrome(const checkedApp *app) {
+    // Unpaced, so the time is spent drawing instead of waiting for vblanks
+    SDL_SetRenderVSync(app->renderer, SDL_RENDERER_VSYNC_DISABLED);
+    Uint64 times[2];
+    chromeRun runs[2] = {{app, false, 0}, {app, true, 0}};
+    for (int round = 0; round < 2; round++)
+        times[round] = timeFrames(app->renderer, BENCH_FRAMES, drawChromeFrame, &runs[round]);
+
+    // Rounding adds the corner tiles' draws, but no fill work
+    int w = app->layout->window.w, h = app->layout->window.h;
+    SDL_Log("%dx%d square chrome: %.0f draw calls, %.3f ms per frame, rounded: %.0f draw calls, "
+            "%.3f ms per frame", w, h, runs[0].draws / (BENCH_FRAMES + 1.0),
+            times[0] / (BENCH_FRAMES * 1e6), runs[1].draws / (BENCH_FRAMES + 1.0),
+            times[1] / (BENCH_FRAMES * 1e6));
+
+    initFramePacing(app->renderer, app->window, app->vsync);
+}
+
+void benchTitleText(const checkedApp *app) {
+    /* A title that changes 1000 times, as a progress display updating every millisecond would,
+     * each time reshaped and drawn. Flushing submits the draw to the GPU without waiting. */
+    const windowLayout *layout = app->layout;
+    const char *windowTitle = SDL_GetWindowTitle(app->window);
+    char string[256];
+    Uint64 changed = 0, unchanged = 0;
+    for (int i = 0; i <= 1000; i++) {
+        SDL_snprintf(string, sizeof(string), "%s (%d)", windowTitle, i);
+        Uint64 start = SDL_GetTicksNS();
+        updateTitleText(string, layout->scale);
+        drawTitleText(&layout->titleText, app->palette->text);
+        SDL_FlushRenderer(app->renderer);
+        // The first update only warms up caches
+        if (i > 0)
+            changed += SDL_GetTicksNS() - start;
+    }
+
+    // The same without changes, which is only drawn
+    for (int i = 0; i < 1000; i++) {
+        Uint64 start = SDL_GetTicksNS();
+        updateTitleText(string, layout->scale);
+        drawTitleText(&layout->titleText, app->palette->text);
+        SDL_FlushRenderer(app->renderer);
+        unchanged += SDL_GetTicksNS() - start;
+    }
+
+    SDL_Log("1000 title updates take %.2f ms, %.1f us each, %.1f%% of a second; an unchanged "
+            "title takes %.1f us to draw", changed / 1e6, changed / 1e6, changed / 1e7,
+            unchanged / 1e6);
+
+    // Show the window's own title again
+    updateTitleText(windowTitle, layout->scale);
+}
+
+static Uint64 countFrameAllocs(void) {
+    return getAllocCount(ALLOC_LAYOUT) + getAllocCount(ALLOC_DRAW) +
+           getAllocCount(ALLOC_PRESENT);
+}
+
+static void drawWindowFrame(void *data) {
+    const checkedApp *app = data;
+    app->drawWindow(NULL);
+}
+
+static void drawChromeFrame(void *data) {
+    chromeRun *run = data;
+    run->draws += run->app->drawChrome(run->rounded);
+}
@@ -0,0 +1,74 @@
+/* 
+  A fully functional SDL3 window with a custom-drawn non-client area and shadow 
+  Copyright (C) 2025 fischflocke
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef CHECKS_H
+#define CHECKS_H
+
+// Standard includes
+#include <stdbool.h>
+
+// SDL3 includes
+#include <SDL3/SDL.h>
+
+// Local includes
+#include "dropshadow.h"
+#include "eventsource.h"
+#include "layout.h"
+#include "palette.h"
+
+/* The app that the checks and benchmarks drive. They run its own layout, drawing and main loop,
+ * and put back the settings they change when done. */
+typedef struct {
+    SDL_Window *window;
+    SDL_Renderer *renderer;
+    const windowLayout *layout;
+    const palette *palette;
+    // Settings to put back, vsync is turned off while benchmarking
+    int vsync;
+    bool edgeToEdge;
+    float shadowOpacity;
+    Uint64 themeFade;
+    // Whether the app already records a capture ring
+    bool captureRing;
+    void (*updateLayout)(void);
+    void (*drawWindow)(SDL_Texture *target);
+    // Draws a full frame right away, as the main loop would
+    void (*redraw)(void);
+    // Runs the main loop until the source quits, and answers live resizes from the watch
+    void (*runMainLoop)(const eventSource *source);
+    SDL_EventFilter watchLiveResize;
+    // Draws only the chrome, with square or rounded corners, and returns its renderer calls
+    Uint64 (*drawChrome)(bool rounded);
+    void (*setEdgeToEdge)(bool edgeToEdge);
+    void (*setShadowOpacity)(float opacity);
+    void (*setThemeFade)(Uint64 duration);
+} checkedApp;
+
+/* Times the images' way to the shadow for the scales, as the time to decode them and to round
+ * their corner for every scale */
+typedef bool (*timeImageShadowFunc)(const float *scales, int count, Uint64 *decode,
+                                    Uint64 *corners);
+
+bool checkSteadyAllocs(const checkedApp *app);
+bool checkMainLoop(const checkedApp *app);
+bool checkShadow(const shadowGeometry *geometry, timeImageShadowFunc timeImageShadow);
+void benchEdgeToEdge(const checkedApp *app);
+void benchRoundedChrome(const checkedApp *app);
+void benchTitleText(const checkedApp *app);
+
+#endif
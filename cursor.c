@@ -0,0 +1,123 @@
+/* 
+  A fully functional SDL3 window with a custom-drawn non-client area and shadow 
+  Copyright (C) 2025 fischflocke
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Standard includes
+#include <stdbool.h>
+
+// SDL3 includes
+#include <SDL3/SDL.h>
+
+// Local includes
+#include "cursor.h"
+#include "trace.h"
+
+// Cursors the window shows, by hit test result and for the caption buttons
+static const SDL_SystemCursor usedCursors[] = {
+    SDL_SYSTEM_CURSOR_DEFAULT,
+    SDL_SYSTEM_CURSOR_POINTER,
+    SDL_SYSTEM_CURSOR_NW_RESIZE,
+    SDL_SYSTEM_CURSOR_N_RESIZE,
+    SDL_SYSTEM_CURSOR_NE_RESIZE,
+    SDL_SYSTEM_CURSOR_E_RESIZE,
+    SDL_SYSTEM_CURSOR_SE_RESIZE,
+    SDL_SYSTEM_CURSOR_S_RESIZE,
+    SDL_SYSTEM_CURSOR_SW_RESIZE,
+    SDL_SYSTEM_CURSOR_W_RESIZE
+};
+
+/* Creating a system cursor loads it from the cursor theme, which can take long enough to drop a
+ * frame. All cursors are created once the first frame is shown, and the cursor is only set when it
+ * changes. System cursors follow the display scale on their own, so one per type is enough. */
+static struct {
+    SDL_Cursor *cursors[SDL_SYSTEM_CURSOR_COUNT];
+    bool created[SDL_SYSTEM_CURSOR_COUNT];
+    bool shown;
+    SDL_SystemCursor current;
+    Uint64 switches;
+    // Cursors that were needed before they were prepared
+    Uint64 misses;
+} cursors;
+
+void prepareCursors(void) {
+    // SDL only creates cursors on the main thread, so this runs between frames
+    Uint64 start = traceNow();
+    for (size_t i = 0; i < SDL_arraysize(usedCursors); i++) {
+        SDL_SystemCursor id = usedCursors[i];
+        if (!cursors.created[id]) {
+            cursors.cursors[id] = SDL_CreateSystemCursor(id);
+            cursors.created[id] = true;
+        }
+    }
+    traceSpan("cursors", start, traceNow());
+}
+
+void destroyCursors(void) {
+    for (int i = 0; i < SDL_SYSTEM_CURSOR_COUNT; i++) {
+        if (cursors.cursors[i])
+            SDL_DestroyCursor(cursors.cursors[i]);
+    }
+    SDL_zero(cursors);
+}
+
+SDL_SystemCursor getHitTestCursor(SDL_HitTestResult result) {
+    switch (result) {
+    case SDL_HITTEST_RESIZE_TOPLEFT:
+        return SDL_SYSTEM_CURSOR_NW_RESIZE;
+    case SDL_HITTEST_RESIZE_TOP:
+        return SDL_SYSTEM_CURSOR_N_RESIZE;
+    case SDL_HITTEST_RESIZE_TOPRIGHT:
+        return SDL_SYSTEM_CURSOR_NE_RESIZE;
+    case SDL_HITTEST_RESIZE_RIGHT:
+        return SDL_SYSTEM_CURSOR_E_RESIZE;
+    case SDL_HITTEST_RESIZE_BOTTOMRIGHT:
+        return SDL_SYSTEM_CURSOR_SE_RESIZE;
+    case SDL_HITTEST_RESIZE_BOTTOM:
+        return SDL_SYSTEM_CURSOR_S_RESIZE;
+    case SDL_HITTEST_RESIZE_BOTTOMLEFT:
+        return SDL_SYSTEM_CURSOR_SW_RESIZE;
+    case SDL_HITTEST_RESIZE_LEFT:
+        return SDL_SYSTEM_CURSOR_W_RESIZE;
+    default:
+        return SDL_SYSTEM_CURSOR_DEFAULT;
+    }
+}
+
+void showCursor(SDL_SystemCursor id) {
+    if (cursors.shown && cursors.current == id)
+        return;
+    cursors.shown = true;
+    cursors.current = id;
+    cursors.switches++;
+
+    // Create it now if it wasn't prepared, which is what preparing avoids
+    if (!cursors.created[id]) {
+        cursors.cursors[id] = SDL_CreateSystemCursor(id);
+        cursors.created[id] = true;
+        cursors.misses++;
+    }
+    if (cursors.cursors[id])
+        SDL_SetCursor(cursors.cursors[id]);
+}
+
+Uint64 getCursorSwitches(void) {
+    return cursors.switches;
+}
+
+Uint64 getCursorMisses(void) {
+    return cursors.misses;
+}
@@ -0,0 +1,331 @@
+/* 
+  A fully functional SDL3 window with a custom-drawn non-client area and shadow 
+  Copyright (C) 2025 fischflocke
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Standard includes
+#include <math.h>
+#include <stdbool.h>
+
+// SDL3 includes
+#include <SDL3/SDL.h>
+
+// Local includes
+#include "dropshadow.h"
+
+static float integrateErf(float t);
+static float *createReferenceShadow(const shadowGeometry *geometry, int cornerRadius, int margin,
+                                    int w, int h);
+static float getAtlasValue(const SDL_Surface *surface, const shadowAtlas *atlas, int x, int y,
+                           int w, int h);
+static bool isInsideRoundedRect(float x, float y, float left, float top, float right,
+                                float bottom, float radius);
+static void fillCorner(SDL_Surface *atlas, const SDL_Rect *tile, bool flipX, bool flipY,
+                       const float *lutX, float edgeX, float edgeY, float sigma, float radius,
+                       int segments, float *scratch);
+
+int getShadowMargin(const shadowGeometry *geometry) {
+    // The shadow fades out one blur radius beyond its box
+    float reach = geometry->radius + geometry->spread +
+            SDL_max(fabsf(geometry->offsetX), fabsf(geometry->offsetY));
+    return SDL_max(0, (int)ceilf(reach));
+}
+
+float evalShadowProfile(float u0, float u1, float edge, float sigma) {
+    /* A box convolved with a Gaussian is a product of two edge profiles, each the Gaussian's
+     * CDF 1/2 (1 + erf((u - edge) / (sigma sqrt 2))). This returns the exact mean of one profile
+     * over the pixel [u0, u1], using the antiderivative of erf, so the result stays correct at
+     * any pixel size. */
+    if (sigma < 1e-3f)
+        return SDL_clamp(u1 - edge, 0.0f, u1 - u0) / (u1 - u0);
+
+    float a = sigma * sqrtf(2);
+    float area = integrateErf((u1 - edge) / a) - integrateErf((u0 - edge) / a);
+    return SDL_clamp(0.5f + 0.5f * a * area / (u1 - u0), 0.0f, 1.0f);
+}
+
+void computeShadowProfile(float *lut, int n, float edge, float sigma) {
+    // Pixel i covers [i, i + 1] measured inwards from the outer end of the margin
+    for (int i = 0; i < n; i++)
+        lut[i] = evalShadowProfile(i, i + 1, edge, sigma);
+}
+
+SDL_Surface *createShadowAtlas(const shadowGeometry *geometry, int cornerRadius,
+                               shadowAtlas *atlas) {
+    float sigma = geometry->radius / 2;
+    int margin = getShadowMargin(geometry);
+
+    /* Corner tiles reach into the window until the shadow's rounded corner no longer shows in
+     * the profiles, three standard deviations past the arc */
+    float offset = SDL_max(fabsf(geometry->offsetX), fabsf(geometry->offsetY));
+    float radius = SDL_max(cornerRadius + geometry->spread, 0.0f);
+    int inside = ceilf(3 * sigma - geometry->spread + offset + radius);
+    int n = margin + SDL_max(inside, cornerRadius);
+
+    /* Atlas layout: the four corners as a 2x2 grid, followed by two one-pixel columns for the
+     * top and bottom edges and two one-pixel rows for the left and right edges */
+    atlas->margin = margin;
+    atlas->size = n;
+    atlas->corners[0] = (SDL_Rect){0, 0, n, n};
+    atlas->corners[1] = (SDL_Rect){n, 0, n, n};
+    atlas->corners[2] = (SDL_Rect){0, n, n, n};
+    atlas->corners[3] = (SDL_Rect){n, n, n, n};
+    atlas->edges[0] = (SDL_Rect){2 * n, 0, 1, margin};
+    atlas->edges[1] = (SDL_Rect){2 * n + 1, 0, 1, margin};
+    atlas->edges[2] = (SDL_Rect){0, 2 * n, margin, 1};
+    atlas->edges[3] = (SDL_Rect){0, 2 * n + 1, margin, 1};
+
+    SDL_Surface *surface = SDL_CreateSurface(2 * n + 2, 2 * n + 2, SDL_PIXELFORMAT_RGBA32);
+    if (!surface)
+        return NULL;
+
+    // White and transparent, so the shadow's color can be set with color modulation
+    for (int y = 0; y < surface->h; y++) {
+        Uint8 *p = (Uint8 *)surface->pixels + y * surface->pitch;
+        for (int x = 0; x < surface->w; x++, p += 4) {
+            p[0] = p[1] = p[2] = 255;
+            p[3] = 0;
+        }
+    }
+
+    // Box edges per side, measured inwards from the outer end of the margin
+    float edges[4] = {
+        margin - geometry->spread + geometry->offsetY,
+        margin - geometry->spread - geometry->offsetY,
+        margin - geometry->spread + geometry->offsetX,
+        margin - geometry->spread - geometry->offsetX
+    };
+
+    // One profile per side, then the corners' tables with about two bands per pixel of arc
+    int segments = SDL_max(1, (int)ceilf((float)M_PI * radius));
+    float *luts = SDL_malloc((4 + 2 * segments + 1) * n * sizeof(float));
+    if (!luts) {
+        SDL_DestroySurface(surface);
+        return NULL;
+    }
+    float *scratch = luts + 4 * n;
+    for (int side = 0; side < 4; side++)
+        computeShadowProfile(luts + side * n, n, edges[side], sigma);
+    const float *top = luts, *bottom = luts + n, *left = luts + 2 * n, *right = luts + 3 * n;
+
+    // Corners
+    fillCorner(surface, &atlas->corners[0], false, false, left, edges[2], edges[0], sigma,
+               radius, segments, scratch);
+    fillCorner(surface, &atlas->corners[1], true, false, right, edges[3], edges[0], sigma,
+               radius, segments, scratch);
+    fillCorner(surface, &atlas->corners[2], false, true, left, edges[2], edges[1], sigma,
+               radius, segments, scratch);
+    fillCorner(surface, &atlas->corners[3], true, true, right, edges[3], edges[1], sigma,
+               radius, segments, scratch);
+
+    // Edges, with the outer end of the margin at the window's border
+    Uint8 *pixels = surface->pixels;
+    int pitch = surface->pitch;
+    for (int i = 0; i < margin; i++) {
+        pixels[i * pitch + 4 * (2 * n) + 3] = top[i] * 255 + 0.5f;
+        pixels[(margin - 1 - i) * pitch + 4 * (2 * n + 1) + 3] = bottom[i] * 255 + 0.5f;
+        pixels[(2 * n) * pitch + 4 * i + 3] = left[i] * 255 + 0.5f;
+        pixels[(2 * n + 1) * pitch + 4 * (margin - 1 - i) + 3] = right[i] * 255 + 0.5f;
+    }
+
+    SDL_free(luts);
+    return surface;
+}
+
+bool measureShadowError(const shadowGeometry *geometry, int cornerRadius, float *edgeError,
+                        float *cornerError) {
+    shadowAtlas atlas;
+    SDL_Surface *surface = createShadowAtlas(geometry, cornerRadius, &atlas);
+    if (!surface)
+        return false;
+
+    // A window with some straight edge between the corner tiles
+    int margin = atlas.margin, w = 2 * atlas.size + 32, h = 2 * atlas.size + 32;
+    float *reference = createReferenceShadow(geometry, cornerRadius, margin, w, h);
+    if (!reference) {
+        SDL_DestroySurface(surface);
+        return false;
+    }
+
+    // Compare where the shadow is visible, outside of the window's rounded background
+    int n = atlas.size;
+    *edgeError = *cornerError = 0;
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            if (isInsideRoundedRect(x + 0.5f, y + 0.5f, margin, margin, w - margin, h - margin,
+                                    cornerRadius))
+                continue;
+            float error = fabsf(getAtlasValue(surface, &atlas, x, y, w, h) - reference[y * w + x]);
+            float *max = (x < n || x >= w - n) && (y < n || y >= h - n) ? cornerError : edgeError;
+            *max = SDL_max(*max, error);
+        }
+    }
+
+    SDL_free(reference);
+    SDL_DestroySurface(surface);
+    return true;
+}
+
+static float *createReferenceShadow(const shadowGeometry *geometry, int cornerRadius, int margin,
+                                    int w, int h) {
+    /* Brute force: the window's rounded rect, grown by the spread and moved by the offset, is
+     * rasterized with 8x8 supersampling and blurred with a sampled Gaussian, which shares no code
+     * with the closed form */
+    float sigma = geometry->radius / 2;
+    int reach = ceilf(4 * sigma);
+    float *coverage = SDL_calloc(2 * (size_t)w * h, sizeof(float));
+    float *kernel = SDL_malloc((2 * reach + 1) * sizeof(float));
+    if (!coverage || !kernel) {
+        SDL_free(coverage);
+        SDL_free(kernel);
+        return NULL;
+    }
+    float *blurred = coverage + w * h;
+
+    float s = geometry->spread;
+    float left = margin - s + geometry->offsetX, right = w - margin + s + geometry->offsetX;
+    float top = margin - s + geometry->offsetY, bottom = h - margin + s + geometry->offsetY;
+    float radius = SDL_max(cornerRadius + s, 0.0f);
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            int inside = 0;
+            for (int sy = 0; sy < 8; sy++) {
+                for (int sx = 0; sx < 8; sx++) {
+                    inside += isInsideRoundedRect(x + (sx + 0.5f) / 8, y + (sy + 0.5f) / 8,
+                                                  left, top, right, bottom, radius);
+                }
+            }
+            coverage[y * w + x] = inside / 64.0f;
+        }
+    }
+
+    // Without blur the coverage is the shadow
+    if (reach == 0) {
+        SDL_free(kernel);
+        return coverage;
+    }
+
+    float total = 0;
+    for (int i = -reach; i <= reach; i++) {
+        kernel[i + reach] = expf(-i * i / (2 * sigma * sigma));
+        total += kernel[i + reach];
+    }
+    for (int i = 0; i <= 2 * reach; i++)
+        kernel[i] /= total;
+
+    // Horizontal pass into the second half, vertical pass back, treating outside as empty
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            float sum = 0;
+            for (int i = -reach; i <= reach; i++) {
+                if (x + i >= 0 && x + i < w)
+                    sum += kernel[i + reach] * coverage[y * w + x + i];
+            }
+            blurred[y * w + x] = sum;
+        }
+    }
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            float sum = 0;
+            for (int i = -reach; i <= reach; i++) {
+                if (y + i >= 0 && y + i < h)
+                    sum += kernel[i + reach] * blurred[(y + i) * w + x];
+            }
+            coverage[y * w + x] = sum;
+        }
+    }
+
+    SDL_free(kernel);
+    return coverage;
+}
+
+static float getAtlasValue(const SDL_Surface *surface, const shadowAtlas *atlas, int x, int y,
+                           int w, int h) {
+    // Where drawAnalyticShadow() puts the atlas' pieces
+    int n = atlas->size, m = atlas->margin;
+    int sx, sy;
+    if ((x < n || x >= w - n) && (y < n || y >= h - n)) {
+        const SDL_Rect *tile = &atlas->corners[(y >= h - n) * 2 + (x >= w - n)];
+        sx = tile->x + (x < n ? x : x - (w - n));
+        sy = tile->y + (y < n ? y : y - (h - n));
+    } else if (y < m) {
+        sx = atlas->edges[0].x;
+        sy = y;
+    } else if (y >= h - m) {
+        sx = atlas->edges[1].x;
+        sy = y - (h - m);
+    } else if (x < m) {
+        sx = x;
+        sy = atlas->edges[2].y;
+    } else if (x >= w - m) {
+        sx = x - (w - m);
+        sy = atlas->edges[3].y;
+    } else {
+        return 0;
+    }
+    return ((const Uint8 *)surface->pixels)[sy * surface->pitch + 4 * sx + 3] / 255.0f;
+}
+
+static bool isInsideRoundedRect(float x, float y, float left, float top, float right,
+                                float bottom, float radius) {
+    if (x < left || x >= right || y < top || y >= bottom)
+        return false;
+    // Distance to the closest corner's center, only within the corner squares
+    float cx = SDL_clamp(x, left + radius, right - radius);
+    float cy = SDL_clamp(y, top + radius, bottom - radius);
+    return (x - cx) * (x - cx) + (y - cy) * (y - cy) <= radius * radius;
+}
+
+static float integrateErf(float t) {
+    // Antiderivative of erf(t)
+    return t * erff(t) + expf(-t * t) / sqrtf((float)M_PI);
+}
+
+static void fillCorner(SDL_Surface *atlas, const SDL_Rect *tile, bool flipX, bool flipY,
+                       const float *lutX, float edgeX, float edgeY, float sigma, float radius,
+                       int segments, float *scratch) {
+    /* The blurred rounded box, one axis at a time: each row of the box is a span whose
+     * horizontal blur is a profile, and the rows are summed with their exact vertical weights.
+     * The arc is cut into bands of rows, the rows past it all share the straight profile */
+    int n = tile->w;
+    float *weights = scratch, *spans = scratch + segments * n, *below = scratch + 2 * segments * n;
+    float step = (float)M_PI / 2 / segments;
+    for (int i = 0; i < n; i++) {
+        below[i] = evalShadowProfile(i, i + 1, edgeY + radius, sigma);
+        for (int k = 0; k < segments; k++) {
+            // Bands of equal angle, so they are thin where the arc runs flat
+            float top = edgeY + radius * (1 - cosf(k * step));
+            float bottom = edgeY + radius * (1 - cosf((k + 1) * step));
+            weights[i * segments + k] = evalShadowProfile(i, i + 1, top, sigma) -
+                    evalShadowProfile(i, i + 1, bottom, sigma);
+            float start = edgeX + radius * (1 - sinf((k + 0.5f) * step));
+            spans[i * segments + k] = evalShadowProfile(i, i + 1, start, sigma);
+        }
+    }
+
+    for (int v = 0; v < n; v++) {
+        for (int u = 0; u < n; u++) {
+            float value = lutX[u] * below[v];
+            for (int k = 0; k < segments; k++)
+                value += weights[v * segments + k] * spans[u * segments + k];
+
+            int x = tile->x + (flipX ? n - 1 - u : u);
+            int y = tile->y + (flipY ? n - 1 - v : v);
+            Uint8 *p = (Uint8 *)atlas->pixels + y * atlas->pitch + 4 * x;
+            p[3] = SDL_min(value, 1.0f) * 255 + 0.5f;
+        }
+    }
+}
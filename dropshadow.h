@@ -0,0 +1,53 @@
+/* 
+  A fully functional SDL3 window with a custom-drawn non-client area and shadow 
+  Copyright (C) 2025 fischflocke
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef DROPSHADOW_H
+#define DROPSHADOW_H
+
+// SDL3 includes
+#include <SDL3/SDL.h>
+
+/* Geometry of an analytic drop shadow in device pixels. The shadow is the window's rounded
+ * rectangle, grown by the spread and moved by the offset, convolved with a Gaussian whose
+ * standard deviation is half the blur radius. */
+typedef struct {
+    float radius;
+    float spread;
+    float offsetX;
+    float offsetY;
+} shadowGeometry;
+
+/* Placement of the pieces inside a shadow atlas. The corners are ordered top left, top right,
+ * bottom left and bottom right, the edges top, bottom, left and right. All pieces are stored in
+ * the orientation they are drawn in. */
+typedef struct {
+    int margin;
+    int size;
+    SDL_Rect corners[4];
+    SDL_Rect edges[4];
+} shadowAtlas;
+
+int getShadowMargin(const shadowGeometry *geometry);
+float evalShadowProfile(float u0, float u1, float edge, float sigma);
+void computeShadowProfile(float *lut, int n, float edge, float sigma);
+SDL_Surface *createShadowAtlas(const shadowGeometry *geometry, int cornerRadius,
+                               shadowAtlas *atlas);
+bool measureShadowError(const shadowGeometry *geometry, int cornerRadius, float *edgeError,
+                        float *cornerError);
+
+#endif
@@ -0,0 +1,215 @@
+/* 
+  A fully functional SDL3 window with a custom-drawn non-client area and shadow 
+  Copyright (C) 2025 fischflocke
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Standard includes
+#include <stdbool.h>
+
+// SDL3 includes
+#include <SDL3/SDL.h>
+
+// Local includes
+#include "eventlog.h"
+
+// Identifies event logs and their version
+#define LOG_MAGIC 0x4c455744
+#define LOG_VERSION 2
+
+static size_t getEventSize(const SDL_Event *event);
+static bool writeLayoutInputs(const layoutInputs *inputs);
+static bool readLayoutInputs(layoutInputs *inputs);
+
+/* An event log starts with a magic number, a version and the inputs of the window's layout,
+ * followed by entries of a kind byte and the time in nanoseconds since the recording started.
+ * Events are stored with the size of their part of the union, hit tests as the point and the
+ * result, and layouts as their inputs. Hit tests depend on the display scale and window size,
+ * which a replay takes from the log instead of its own window. Numbers are little endian, but
+ * events are stored as they are in memory, so logs only replay on machines of the same kind. */
+static struct {
+    SDL_IOStream *io;
+    Uint64 start;
+    bool replaying;
+    bool realTime;
+    // Entry that was read but isn't due yet
+    logEntry next;
+    bool hasNext;
+} eventLog;
+
+bool startRecording(const char *path, const layoutInputs *initial) {
+    eventLog.io = SDL_IOFromFile(path, "wb");
+    if (!eventLog.io)
+        return false;
+    eventLog.start = SDL_GetTicksNS();
+    eventLog.replaying = false;
+    return SDL_WriteU32LE(eventLog.io, LOG_MAGIC) && SDL_WriteU32LE(eventLog.io, LOG_VERSION) &&
+           writeLayoutInputs(initial);
+}
+
+void stopRecording(void) {
+    if (eventLog.io && !eventLog.replaying) {
+        SDL_CloseIO(eventLog.io);
+        eventLog.io = NULL;
+    }
+}
+
+void logEvent(const SDL_Event *event) {
+    if (!eventLog.io || eventLog.replaying)
+        return;
+    size_t size = getEventSize(event);
+    SDL_WriteU8(eventLog.io, LOG_EVENT);
+    SDL_WriteU64LE(eventLog.io, SDL_GetTicksNS() - eventLog.start);
+    SDL_WriteU16LE(eventLog.io, size);
+    SDL_WriteIO(eventLog.io, event, size);
+}
+
+void logHitTest(const SDL_Point *point, int result) {
+    if (!eventLog.io || eventLog.replaying)
+        return;
+    SDL_WriteU8(eventLog.io, LOG_HIT_TEST);
+    SDL_WriteU64LE(eventLog.io, SDL_GetTicksNS() - eventLog.start);
+    SDL_WriteS32LE(eventLog.io, point->x);
+    SDL_WriteS32LE(eventLog.io, point->y);
+    SDL_WriteS32LE(eventLog.io, result);
+}
+
+void logLayout(const layoutInputs *inputs) {
+    if (!eventLog.io || eventLog.replaying)
+        return;
+    SDL_WriteU8(eventLog.io, LOG_LAYOUT);
+    SDL_WriteU64LE(eventLog.io, SDL_GetTicksNS() - eventLog.start);
+    writeLayoutInputs(inputs);
+}
+
+bool startReplay(const char *path, bool realTime, layoutInputs *initial) {
+    eventLog.io = SDL_IOFromFile(path, "rb");
+    if (!eventLog.io)
+        return false;
+    Uint32 magic, version;
+    if (!SDL_ReadU32LE(eventLog.io, &magic) || !SDL_ReadU32LE(eventLog.io, &version) ||
+        magic != LOG_MAGIC || version != LOG_VERSION || !readLayoutInputs(initial)) {
+        SDL_CloseIO(eventLog.io);
+        eventLog.io = NULL;
+        return SDL_SetError("%s is not an event log of this version", path);
+    }
+    eventLog.replaying = true;
+    eventLog.realTime = realTime;
+    eventLog.start = 0;
+    return true;
+}
+
+void stopReplay(void) {
+    if (eventLog.io && eventLog.replaying) {
+        SDL_CloseIO(eventLog.io);
+        eventLog.io = NULL;
+    }
+    eventLog.replaying = false;
+}
+
+bool isReplaying(void) {
+    return eventLog.replaying;
+}
+
+bool isRealTimeReplay(void) {
+    return eventLog.replaying && eventLog.realTime;
+}
+
+/* Reads the next entry. In real time, an entry that isn't due yet is kept back and the time until
+ * it is due is returned in wait instead. */
+bool readLogEntry(logEntry *entry, Uint64 *wait) {
+    logEntry *next = &eventLog.next;
+    *wait = 0;
+    if (!eventLog.replaying)
+        return false;
+
+    if (!eventLog.hasNext) {
+        Uint8 kind;
+        Uint16 size;
+        SDL_zerop(next);
+        if (!SDL_ReadU8(eventLog.io, &kind) || !SDL_ReadU64LE(eventLog.io, &next->time))
+            return false;
+        next->kind = kind;
+        if (kind == LOG_EVENT) {
+            if (!SDL_ReadU16LE(eventLog.io, &size) || size > sizeof(next->event) ||
+                SDL_ReadIO(eventLog.io, &next->event, size) != size)
+                return false;
+        } else if (kind == LOG_LAYOUT) {
+            if (!readLayoutInputs(&next->layout))
+                return false;
+        } else if (!SDL_ReadS32LE(eventLog.io, &next->point.x) ||
+                   !SDL_ReadS32LE(eventLog.io, &next->point.y) ||
+                   !SDL_ReadS32LE(eventLog.io, &next->result)) {
+            return false;
+        }
+        eventLog.hasNext = true;
+    }
+
+    // The replay's clock starts with its first entry
+    if (eventLog.realTime) {
+        Uint64 now = SDL_GetTicksNS();
+        if (!eventLog.start)
+            eventLog.start = now - next->time;
+        if (eventLog.start + next->time > now) {
+            *wait = eventLog.start + next->time - now;
+            return false;
+        }
+    }
+
+    *entry = *next;
+    eventLog.hasNext = false;
+    return true;
+}
+
+static size_t getEventSize(const SDL_Event *event) {
+    // Only what the event's type uses of the union, which is the larger part of a log otherwise
+    if (event->type >= SDL_EVENT_DISPLAY_FIRST && event->type <= SDL_EVENT_DISPLAY_LAST)
+        return sizeof(SDL_DisplayEvent);
+    if (event->type >= SDL_EVENT_WINDOW_FIRST && event->type <= SDL_EVENT_WINDOW_LAST)
+        return sizeof(SDL_WindowEvent);
+    switch (event->type) {
+    case SDL_EVENT_KEY_DOWN:
+    case SDL_EVENT_KEY_UP:
+        return sizeof(SDL_KeyboardEvent);
+    case SDL_EVENT_MOUSE_MOTION:
+        return sizeof(SDL_MouseMotionEvent);
+    case SDL_EVENT_MOUSE_BUTTON_DOWN:
+    case SDL_EVENT_MOUSE_BUTTON_UP:
+        return sizeof(SDL_MouseButtonEvent);
+    case SDL_EVENT_QUIT:
+    case SDL_EVENT_SYSTEM_THEME_CHANGED:
+        return sizeof(SDL_CommonEvent);
+    }
+    return sizeof(SDL_Event);
+}
+
+static bool writeLayoutInputs(const layoutInputs *inputs) {
+    // The scale as its bits, which keeps it exact
+    Uint32 scale;
+    SDL_memcpy(&scale, &inputs->scale, sizeof(scale));
+    return SDL_WriteU32LE(eventLog.io, scale) && SDL_WriteS32LE(eventLog.io, inputs->w) &&
+           SDL_WriteS32LE(eventLog.io, inputs->h) && SDL_WriteU64LE(eventLog.io, inputs->state);
+}
+
+static bool readLayoutInputs(layoutInputs *inputs) {
+    Uint32 scale;
+    Uint64 state;
+    if (!SDL_ReadU32LE(eventLog.io, &scale) || !SDL_ReadS32LE(eventLog.io, &inputs->w) ||
+        !SDL_ReadS32LE(eventLog.io, &inputs->h) || !SDL_ReadU64LE(eventLog.io, &state))
+        return false;
+    SDL_memcpy(&inputs->scale, &scale, sizeof(scale));
+    inputs->state = state;
+    return true;
+}
@@ -0,0 +1,67 @@
+/* 
+  A fully functional SDL3 window with a custom-drawn non-client area and shadow 
+  Copyright (C) 2025 fischflocke
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef EVENTLOG_H
+#define EVENTLOG_H
+
+// Standard includes
+#include <stdbool.h>
+
+// SDL3 includes
+#include <SDL3/SDL.h>
+
+// Kinds of entries in an event log
+typedef enum {
+    LOG_EVENT,
+    LOG_HIT_TEST,
+    LOG_LAYOUT
+} logEntryKind;
+
+// What the window's layout depends on, so a replay lays out like the recorded session
+typedef struct {
+    float scale;
+    // Size in pixels
+    int w;
+    int h;
+    // Maximized and fullscreen flags
+    SDL_WindowFlags state;
+} layoutInputs;
+
+// An entry read back from an event log
+typedef struct {
+    logEntryKind kind;
+    // Nanoseconds since the recording started
+    Uint64 time;
+    SDL_Event event;
+    SDL_Point point;
+    int result;
+    layoutInputs layout;
+} logEntry;
+
+bool startRecording(const char *path, const layoutInputs *initial);
+void stopRecording(void);
+void logEvent(const SDL_Event *event);
+void logHitTest(const SDL_Point *point, int result);
+void logLayout(const layoutInputs *inputs);
+bool startReplay(const char *path, bool realTime, layoutInputs *initial);
+void stopReplay(void);
+bool isReplaying(void);
+bool isRealTimeReplay(void);
+bool readLogEntry(logEntry *entry, Uint64 *wait);
+
+#endif
@@ -0,0 +1,125 @@
+/* 
+  A fully functional SDL3 window with a custom-drawn non-client area and shadow 
+  Copyright (C) 2025 fischflocke
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Standard includes
+#include <stdbool.h>
+
+// SDL3 includes
+#include <SDL3/SDL.h>
+
+// Local includes
+#include "eventsource.h"
+#include "trace.h"
+
+static bool waitForSystemEvent(void *data, SDL_Event *event, Sint32 timeout);
+static bool waitForScriptedEvent(void *data, SDL_Event *event, Sint32 timeout);
+
+/* A script plays its events on a virtual clock, which replaces the trace clock while it runs and
+ * starts at the real time, so timestamps taken before stay in order. Waiting for an event
+ * advances the clock to the event or by the timeout, whichever is first, so a script runs
+ * instantly and always the same way. After the last event and the end time, it sends a quit
+ * event.
+ *
+ * Like SDL's event watches, the watch sees every event as it happens. A run of modal events is
+ * played to the watch alone, and only queued for the main loop once the run is over. */
+static struct {
+    const scriptedEvent *events;
+    int count;
+    // Next event to play, and next one to return to the main loop
+    int next;
+    int queued;
+    // Clock when the last run started, which its queued events can't be older than
+    Uint64 run;
+    Uint64 end;
+    SDL_EventFilter watch;
+    // Real time at the start, which script times are relative to
+    Uint64 origin;
+    Uint64 now;
+} script;
+
+eventSource getSystemEventSource(void) {
+    return (eventSource){waitForSystemEvent, NULL, false};
+}
+
+eventSource startScript(const scriptedEvent *events, int count, Uint64 end,
+                        SDL_EventFilter watch) {
+    script.events = events;
+    script.count = count;
+    script.next = 0;
+    script.queued = 0;
+    script.end = end;
+    script.watch = watch;
+    script.origin = traceNow();
+    script.now = script.origin;
+    setTraceClock(getScriptTime);
+    return (eventSource){waitForScriptedEvent, NULL, false};
+}
+
+void stopScript(void) {
+    setTraceClock(NULL);
+    SDL_zero(script);
+}
+
+Uint64 getScriptTime(void) {
+    return script.now;
+}
+
+static bool waitForSystemEvent(void *data, SDL_Event *event, Sint32 timeout) {
+    return SDL_WaitEventTimeout(event, timeout);
+}
+
+static bool waitForScriptedEvent(void *data, SDL_Event *event, Sint32 timeout) {
+    // Events reach the main loop after the watch has seen them
+    if (script.queued < script.next) {
+        const scriptedEvent *queued = &script.events[script.queued++];
+        *event = queued->event;
+        event->common.timestamp = SDL_max(script.run, script.origin + queued->time);
+        return true;
+    }
+
+    // Quit once everything has been played
+    bool done = script.next == script.count;
+    Uint64 due = script.origin + (done ? script.end : script.events[script.next].time);
+    Uint64 deadline = script.now + (Uint64)SDL_max(timeout, 0) * SDL_NS_PER_MS;
+    if (due > deadline) {
+        script.now = deadline;
+        return false;
+    }
+
+    script.now = SDL_max(script.now, due);
+    if (done) {
+        *event = (SDL_Event){.type = SDL_EVENT_QUIT};
+        event->common.timestamp = script.now;
+        return true;
+    }
+
+    /* Play the event to the watch, and a modal one with the rest of its run, since the main loop
+     * doesn't get to run until the run is over */
+    script.run = script.now;
+    do {
+        const scriptedEvent *next = &script.events[script.next++];
+        script.now = SDL_max(script.now, script.origin + next->time);
+        SDL_Event watched = next->event;
+        watched.common.timestamp = script.now;
+        if (script.watch)
+            script.watch(NULL, &watched);
+    } while (script.events[script.next - 1].modal && script.next < script.count &&
+             script.events[script.next].modal);
+
+    return waitForScriptedEvent(data, event, timeout);
+}
@@ -0,0 +1,51 @@
+/* 
+  A fully functional SDL3 window with a custom-drawn non-client area and shadow 
+  Copyright (C) 2025 fischflocke
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef EVENTSOURCE_H
+#define EVENTSOURCE_H
+
+// Standard includes
+#include <stdbool.h>
+
+// SDL3 includes
+#include <SDL3/SDL.h>
+
+/* Where the main loop gets its events from. wait returns the next event, or false if the timeout
+ * in milliseconds passed without one. Sources that set immediate have frames drawn as soon as
+ * they're needed instead of paced to the display. */
+typedef struct {
+    bool (*wait)(void *data, SDL_Event *event, Sint32 timeout);
+    void *data;
+    bool immediate;
+} eventSource;
+
+/* An event of a script and when it happens, in nanoseconds of the script's clock. Modal events
+ * happen while the system holds the main loop, like Windows and macOS do during a live resize. */
+typedef struct {
+    Uint64 time;
+    SDL_Event event;
+    bool modal;
+} scriptedEvent;
+
+eventSource getSystemEventSource(void);
+eventSource startScript(const scriptedEvent *events, int count, Uint64 end,
+                        SDL_EventFilter watch);
+void stopScript(void);
+Uint64 getScriptTime(void);
+
+#endif
@@ -0,0 +1,93 @@
+/* 
+  A fully functional SDL3 window with a custom-drawn non-client area and shadow 
+  Copyright (C) 2025 fischflocke
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Standard includes
+#include <math.h>
+#include <stdbool.h>
+
+// SDL3 includes
+#include <SDL3/SDL.h>
+
+// Local includes
+#include "fade.h"
+#include "palette.h"
+#include "trace.h"
+
+// Most frames a fade is precomputed for, longer ones are played back at a lower rate
+#define MAX_FADE_FRAMES 512
+
+/* A fade between two palettes is computed once for every frame it will be shown in, so drawing a
+ * frame of it only picks the colors, which are mixed in linear light. */
+static struct {
+    palette *frames;
+    int count;
+    Uint64 start;
+    Uint64 duration;
+} fade;
+
+bool startPaletteFade(const palette *from, const palette *to, Uint64 duration, float refreshRate) {
+    SDL_free(fade.frames);
+    fade.frames = NULL;
+    if (!duration)
+        return false;
+
+    // One frame per refresh, including both ends
+    int count = ceilf(duration / 1e9f * refreshRate) + 1;
+    count = SDL_clamp(count, 2, MAX_FADE_FRAMES);
+    fade.frames = SDL_malloc(count * sizeof(palette));
+    if (!fade.frames)
+        return false;
+
+    for (int i = 0; i < count; i++) {
+        // Ease in and out
+        float t = (float)i / (count - 1);
+        t = t * t * (3 - 2 * t);
+        palette *p = &fade.frames[i];
+        p->border = mixColors(from->border, to->border, t);
+        p->background = mixColors(from->background, to->background, t);
+        p->titleBar = mixColors(from->titleBar, to->titleBar, t);
+        p->text = mixColors(from->text, to->text, t);
+    }
+    fade.count = count;
+    fade.start = traceNow();
+    fade.duration = duration;
+    return true;
+}
+
+bool getFadePalette(Uint64 now, palette *colors) {
+    if (!fade.frames)
+        return false;
+
+    // Pick the frame by time, so dropped frames don't slow the fade down
+    Uint64 elapsed = now - fade.start;
+    int i = fade.count - 1;
+    if (elapsed < fade.duration)
+        i = elapsed * i / fade.duration;
+    *colors = fade.frames[i];
+
+    // The last frame ends the fade
+    if (i == fade.count - 1) {
+        SDL_free(fade.frames);
+        fade.frames = NULL;
+    }
+    return true;
+}
+
+bool isPaletteFading(void) {
+    return fade.frames != NULL;
+}
@@ -0,0 +1,162 @@
+/* 
+  A fully functional SDL3 window with a custom-drawn non-client area and shadow 
+  Copyright (C) 2025 fischflocke
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Standard includes
+#include <math.h>
+#include <stdbool.h>
+
+// SDL3 includes
+#include <SDL3/SDL.h>
+
+// Local includes
+#include "layout.h"
+
+layoutMetrics getLayoutMetrics(float scale) {
+    layoutMetrics metrics;
+    metrics.border = SDL_max(1, (int)floorf(scale));
+    metrics.radius = ceilf(8 * scale);
+    metrics.titleBarHeight = ceilf(30 * scale);
+    metrics.edgeTol = ceilf(2 * scale);
+    metrics.cornerTol = ceilf(8 * scale);
+    metrics.buttonSize = ceilf(22 * scale);
+    return metrics;
+}
+
+void computeLayout(windowLayout *layout, int w, int h, int margin) {
+    int b = layout->metrics.border;
+    layout->margin = margin;
+
+    // Window size
+    layout->window = (SDL_Rect){0, 0, w, h};
+
+    // Background area without shadows
+    layout->background = (SDL_Rect){margin, margin, w - 2 * margin, h - 2 * margin};
+
+    // Title area
+    layout->titleBar.x = layout->background.x + b;
+    layout->titleBar.y = layout->background.y + b;
+    layout->titleBar.w = layout->background.w - 2 * b;
+    layout->titleBar.h = layout->metrics.titleBarHeight;
+
+    // Client area, taking the remaining height below the title bar's border
+    layout->clientArea.x = layout->titleBar.x;
+    layout->clientArea.y = layout->titleBar.y + layout->titleBar.h + b;
+    layout->clientArea.w = layout->titleBar.w;
+    layout->clientArea.h = SDL_max(0, layout->background.y + layout->background.h - b -
+                                   layout->clientArea.y);
+
+    /* Caption buttons, vertically centered and as far from each other and the right end as from
+     * the top. That keeps the last one inside the rounded corner. */
+    int size = layout->metrics.buttonSize;
+    int gap = (layout->titleBar.h - size) / 2;
+    int right = layout->titleBar.x + layout->titleBar.w;
+    for (int i = 0; i < CAPTION_BUTTONS; i++) {
+        layout->buttons[i] = (SDL_Rect){right - (CAPTION_BUTTONS - i) * (size + gap),
+                                        layout->titleBar.y + gap, size, size};
+    }
+
+    // The title stays centered, so it keeps the buttons' width free on both sides
+    int caption = CAPTION_BUTTONS * (size + gap);
+    layout->titleText = (SDL_Rect){layout->titleBar.x + caption, layout->titleBar.y,
+                                   SDL_max(0, layout->titleBar.w - 2 * caption),
+                                   layout->titleBar.h};
+}
+
+captionButton getCaptionButtonAt(const windowLayout *layout, const SDL_Point *pos, int tolerance) {
+    for (int i = 0; i < CAPTION_BUTTONS; i++) {
+        const SDL_Rect *b = &layout->buttons[i];
+        SDL_Rect area = {b->x - tolerance, b->y - tolerance, b->w + 2 * tolerance,
+                         b->h + 2 * tolerance};
+        if (SDL_PointInRect(pos, &area))
+            return i;
+    }
+    return CAPTION_NONE;
+}
+
+bool checkLayout(const windowLayout *layout) {
+    const SDL_Rect *win = &layout->window, *bg = &layout->background;
+    const SDL_Rect *title = &layout->titleBar, *client = &layout->clientArea;
+    int b = layout->metrics.border;
+
+    // The background is centered in the window with the margin around it
+    if (bg->x != layout->margin || bg->y != layout->margin ||
+            bg->x + bg->w + layout->margin != win->w || bg->y + bg->h + layout->margin != win->h)
+        return false;
+
+    // Title bar and client area are inset by exactly one border on the sides
+    if (title->x != bg->x + b || client->x != title->x || title->w != client->w ||
+            title->x + title->w + b != bg->x + bg->w)
+        return false;
+
+    // Border, title bar, border, client area and border stack up to the background's height
+    if (title->y != bg->y + b || client->y != title->y + title->h + b ||
+            client->y + client->h + b != bg->y + bg->h)
+        return false;
+
+    // The rounded corners fit into each rect
+    int r = layout->metrics.radius;
+    if (bg->w < 2 * r || bg->h < 2 * r || title->h < r - b || client->h < r - b)
+        return false;
+
+    /* The caption buttons lie within the title bar, the last one inside its rounded corner, and
+     * don't overlap each other or the title */
+    for (int i = 0; i < CAPTION_BUTTONS; i++) {
+        const SDL_Rect *button = &layout->buttons[i];
+        SDL_Rect inside;
+        if (!SDL_GetRectIntersection(button, title, &inside) || !SDL_RectsEqual(&inside, button))
+            return false;
+        if (i > 0 && SDL_HasRectIntersection(button, &layout->buttons[i - 1]))
+            return false;
+        if (layout->titleText.w > 0 && SDL_HasRectIntersection(button, &layout->titleText))
+            return false;
+    }
+    int inner = r - b, gap = layout->buttons[0].y - title->y;
+    if (2 * (inner - gap) * (inner - gap) > inner * inner && gap < inner)
+        return false;
+
+    // Nothing is empty or overlapping
+    return title->w > 0 && title->h > 0 && !SDL_HasRectIntersection(title, client);
+}
+
+bool checkLayouts(void) {
+    /* Sweep all scales from 1 to 4 in steps of 1%, and all window sizes from the minimum of 126
+     * points up to 8K. Horizontal and vertical layout don't depend on each other, so square
+     * windows cover all cases. The image shadow margin, a scaled one and none at all, as an
+     * edge-to-edge window has, are checked. */
+    int failures = 0;
+    for (int percent = 100; percent <= 400; percent++) {
+        float scale = percent / 100.0f;
+        windowLayout layout = {.scale = scale, .metrics = getLayoutMetrics(scale)};
+        int margins[] = {16, ceilf(16 * scale), 0};
+
+        for (size_t i = 0; i < SDL_arraysize(margins); i++) {
+            layout.edgeToEdge = margins[i] == 0;
+            for (int size = 126 * scale; size <= 8192; size++) {
+                computeLayout(&layout, size, size, margins[i]);
+                if (!checkLayout(&layout)) {
+                    SDL_Log("Layout check failed: scale %.2f, size %d, margin %d", scale, size,
+                            margins[i]);
+                    failures++;
+                }
+            }
+        }
+    }
+
+    SDL_Log("Layout check: %d failures", failures);
+    return failures == 0;
+}
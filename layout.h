@@ -0,0 +1,72 @@
+/* 
+  A fully functional SDL3 window with a custom-drawn non-client area and shadow 
+  Copyright (C) 2025 fischflocke
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef LAYOUT_H
+#define LAYOUT_H
+
+// Standard includes
+#include <stdbool.h>
+
+// SDL3 includes
+#include <SDL3/SDL.h>
+
+/* Layout constants in device pixels, derived from the display scale. Border widths round down, so
+ * they never get thicker than the scale suggests; everything else rounds up. */
+typedef struct {
+    int border;
+    int radius;
+    int titleBarHeight;
+    int edgeTol;
+    int cornerTol;
+    int buttonSize;
+} layoutMetrics;
+
+// Caption buttons, in their order from left to right
+typedef enum {
+    CAPTION_NONE = -1,
+    CAPTION_MINIMIZE,
+    CAPTION_MAXIMIZE,
+    CAPTION_CLOSE,
+    CAPTION_BUTTONS
+} captionButton;
+
+/* The window's layout in device pixels, shared by the renderer and the hit test. All rects are
+ * derived from the window size, the shadow margin and the metrics with integer arithmetic only,
+ * so adjacent rects always meet exactly, without gaps or seams at fractional scales. */
+typedef struct {
+    SDL_Rect window;
+    SDL_Rect background;
+    SDL_Rect titleBar;
+    SDL_Rect clientArea;
+    // Caption buttons at the right end of the title bar, and the title text centered between
+    SDL_Rect buttons[CAPTION_BUTTONS];
+    SDL_Rect titleText;
+    // Maximized or fullscreen, drawn opaque without shadow, rounded corners and resize borders
+    bool edgeToEdge;
+    float scale;
+    int margin;
+    layoutMetrics metrics;
+} windowLayout;
+
+layoutMetrics getLayoutMetrics(float scale);
+void computeLayout(windowLayout *layout, int w, int h, int margin);
+captionButton getCaptionButtonAt(const windowLayout *layout, const SDL_Point *pos, int tolerance);
+bool checkLayout(const windowLayout *layout);
+bool checkLayouts(void);
+
+#endif
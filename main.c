@@ -28,60 +28,301 @@
 #include <SDL3_ttf/SDL_ttf.h>
 
 // Local includes
+#include "alloc.h"
+#include "appearance.h"
+#include "caption.h"
+#include "capture.h"
+#include "checks.h"
+#include "cursor.h"
+#include "dropshadow.h"
+#include "eventlog.h"
+#include "eventsource.h"
+#include "fade.h"
+#include "layout.h"
+#include "pacing.h"
+#include "palette.h"
+#include "region.h"
+#include "renderstate.h"
+#include "rendertune.h"
+#include "stats.h"
+#include "themefile.h"
+#include "titletext.h"
+#include "trace.h"
 #include "shadow.h"
 
+/* Alpha of the darkest pixels in the shadow images, in the corner image. The shadow's opacity
+ * refers to them, so the images are tinted with the ratio of the two. */
+#define SHADOW_IMAGE_PEAK_ALPHA 130
+
+void parseArguments(int argc, char *argv[]);
 bool initSDL(void);
 bool createWindow(void);
 void destroyWindow(void);
+void finishStartup(void);
+void runMainLoop(const eventSource *source);
 void handleEvent(const SDL_Event *event);
+void handleCaptionEvent(const SDL_Event *event);
+void clickCaptionButton(captionButton button);
+void updateCursor(float x, float y);
+bool waitForReplayedEvent(void *data, SDL_Event *event, Sint32 timeout);
+void sizeReplayedWindow(void);
+void replayHitTest(const logEntry *entry);
+bool SDLCALL watchLiveResize(void *data, SDL_Event *event);
+checkedApp getCheckedApp(void);
+void redrawNow(void);
+void runScriptedLoop(const eventSource *source);
+Uint64 drawChrome(bool rounded);
+void setEdgeToEdge(bool edgeToEdge);
+void setThemeFade(Uint64 duration);
 SDL_HitTestResult hitTest(SDL_Window *win, const SDL_Point *area, void *data);
-void drawWindow(void);
+SDL_HitTestResult hitTestLayout(const SDL_Point *area);
+void requestRedraw(const char *cause, Uint64 timestamp);
+void requestButtonRedraw(Uint32 buttons, Uint64 timestamp);
+void addRedrawCause(const char *cause, Uint64 timestamp);
+bool isRedrawPending(void);
+void renderFrame(void);
+void drawWindow(SDL_Texture *target);
+bool drawDamage(void);
+void presentFrame(SDL_Texture *copy);
+void reserveFrameCopy(void);
+void resetFrameCopy(bool lost);
 void drawShadow(void);
+void drawAnalyticShadow(void);
+void drawRoundedRect(const SDL_Rect *rect, SDL_Color c, const SDL_FRect *tile,
+                     bool top, bool bottom);
+void startAssetPreparation(void);
+int prepareAssets(void *data);
+void decodeImageResources(void);
 void loadImageResources(void);
 void updateLayout(void);
+void getLayoutInputs(layoutInputs *inputs);
+void initScales(void);
+void scanDisplays(void);
+void addDisplayScales(void);
+void startScaleWorker(void);
+int prepareScales(void *data);
+struct scaleResources *getScaleResources(float scale);
+struct scaleResources *findScale(float scale);
+struct scaleResources *addScale(float scale);
+void releaseScale(struct scaleResources *res);
+void storeScalePixels(struct scaleResources *res, struct scaleResources *built, int generation);
+void activateScale(const struct scaleResources *res);
+bool buildScalePixels(struct scaleResources *res, const shadowGeometry *geometry);
+SDL_Surface *createCornerMask(int outer, int inner);
+SDL_Surface *createShadowCorner(int radius);
+SDL_Surface *loadShadowImage(unsigned char *png, unsigned int len);
+bool timeImageShadow(const float *scales, int count, Uint64 *decode, Uint64 *corners);
+void setShadowRadius(float radius);
+void setShadowSpread(float spread);
+void setShadowOffset(float x, float y);
+void setShadowOpacity(float opacity);
+void setShadowColor(SDL_Color color);
+void invalidateShadowGeometry(void);
+void updateThemePalette(void);
+void fadeToTheme(void);
+void applyShadowTint(void);
 
 SDL_Window *wnd = NULL;
 SDL_Renderer *rnd = NULL;
 bool appShouldExit = false;
 bool windowShouldBeRedrawn = true;
+bool startupFinished = false;
+int exitStatus = EXIT_SUCCESS;
 
 struct {
-    SDL_FRect window;
-    SDL_FRect background;
-    SDL_FRect titleBar;
-    SDL_FRect clientArea;
-    float scale;
-} layout;
+    const char *font;
+    bool text;
+    bool trace;
+    const char *traceFile;
+    bool stats;
+    const char *statsFile;
+    bool checkAllocs;
+    bool checkLoop;
+    bool benchEdgeToEdge;
+    bool benchRounded;
+    bool benchTitle;
+    bool checkRegions;
+    bool edgeToEdge;
+    bool autoRenderer;
+    int vsync;
+    const char *themeFile;
+    Uint64 themeFade;
+    const char *mockAppearance;
+    int captureRing;
+    const char *recordFile;
+    const char *replayFile;
+    bool replayRealTime;
+} options = {
+    .text = true,
+    .vsync = 1
+};
+
+windowLayout layout;
+
+/* Windows and macOS block the main loop while the window is resized, so resizes are also
+ * answered from an event watch, which runs as soon as the event is sent. It lays out new sizes
+ * right away, but only draws while the main loop is blocked. */
+struct {
+    bool rendering;
+    // Timestamp of the last event answered by the watch, queued copies of it are ignored
+    Uint64 answered;
+} live;
+
+/* Hit tests of a replayed log whose result differed from the recorded one. The recorded scale,
+ * size and window state decide the layout, since hit tests depend on them and the replaying
+ * display or window manager may differ or apply them late. */
+struct {
+    int hitTests;
+    int mismatches;
+    layoutInputs inputs;
+} replayed;
+
+// Events that the next frame will show, with the time of the first one of each kind
+struct {
+    const char *causes[8];
+    Uint64 times[8];
+    int count;
+} pendingRedraw;
 
 struct {
     SDL_Texture *bottom;
     SDL_Texture *corner;
     SDL_Texture *left;
-} shadow;
+    // Decoded images, the corner is kept for regenerating its texture
+    SDL_Surface *cornerSource;
+    SDL_Surface *bottomSource;
+    SDL_Surface *leftSource;
+    SDL_Semaphore *decoded;
+    // Analytic shadow, evaluated at runtime instead of loaded from images
+    bool analytic;
+    shadowGeometry geometry;
+    shadowAtlas atlas;
+    SDL_Texture *texture;
+    int margin;
+    // Tint of both kinds of shadow, only applied as color and alpha modulation
+    float opacity;
+    SDL_Color color;
+} shadow = {
+    .geometry = {20, -4, 0, 0},
+    .opacity = 0.15,
+    .color = {0, 0, 0, 255}
+};
 
-typedef struct {
-    SDL_Color border;
-    SDL_Color background;
-    SDL_Color titleBar;
-} palette;
+struct {
+    SDL_Texture *mask;
+    SDL_FRect outer;
+    SDL_FRect inner;
+    // Renderer calls issued by drawRoundedRect(), counted for --bench-rounded
+    Uint64 draws;
+} corners;
+
+/* Caption buttons change on their own when hovered or pressed. Only their rects are redrawn then,
+ * on top of a copy of the last frame. Full frames go straight to the window, so the copy is only
+ * refreshed by the first damage after one. Frames are drawn into its top left corner, and it only
+ * grows in steps, so resizing between hovers doesn't recreate it every time. */
+struct {
+    SDL_Texture *icons;
+    // Buttons whose state changed since the last frame, as a bit per button
+    Uint32 damaged;
+    SDL_Texture *frame;
+    // Whether the copy holds the last frame
+    bool current;
+    int frameW;
+    int frameH;
+} captionButtons;
+
+/* Layout constants and shadow resources for one display scale. They are prepared in the background
+ * for every connected display, so moving the window to another monitor only swaps them in. */
+typedef struct scaleResources {
+    bool used;
+    float scale;
+    layoutMetrics metrics;
+    // Pixels, built by the worker or on demand, and the textures uploaded from them
+    bool building;
+    int pixelGeneration;
+    int textureGeneration;
+    SDL_Surface *maskPixels;
+    SDL_Surface *shadowPixels;
+    SDL_Surface *iconPixels;
+    shadowAtlas atlas;
+    SDL_Texture *mask;
+    SDL_Texture *shadow;
+    SDL_Texture *icons;
+} scaleResources;
+
+struct {
+    scaleResources entries[8];
+    // Bumped whenever the shadow geometry changes, which invalidates all shadow pixels
+    int generation;
+    shadowGeometry geometry;
+    SDL_Mutex *mutex;
+    SDL_Condition *built;
+    SDL_Thread *worker;
+    bool working;
+} scales;
 
 struct {
     palette light;
     palette dark;
-    bool useLight;
+    // System settings, which derive the active palette from the light or dark one
+    appearanceSource source;
+    appearance settings;
+    palette active;
+    // Colors of the last frame, which a fade to a new theme starts from
+    palette shown;
 } theme = {
-    .light = {{200, 200, 200, 255}, {227, 227, 227, 255}, {255, 255, 255, 255}},
-    .dark = {{55, 55, 55, 255}, {27, 27, 27, 255}, {0, 0, 0, 255}},
-    .useLight = true
+    .light = {{200, 200, 200, 255}, {227, 227, 227, 255}, {255, 255, 255, 255},
+              {40, 40, 40, 255}},
+    .dark = {{55, 55, 55, 255}, {27, 27, 27, 255}, {0, 0, 0, 255}, {230, 230, 230, 255}}
 };
 
-int main(void) {
-    // Init SDL and create window and renderer
+int main(int argc, char *argv[]) {
+    // Count allocations, which has to start before SDL allocates anything
+    initAllocTracking();
+    // Start timing the startup
+    initTrace();
+    Uint64 start;
+
+    // Apply command line options
+    parseArguments(argc, argv);
+
+    // Init SDL
+    start = traceNow();
     if (!initSDL())
         return EXIT_FAILURE;
+    traceSpan("SDL init", start, traceNow());
+
+    // Decode and generate the shadow in the background while the window is created
+    startAssetPreparation();
+    // Load the palettes from a file and follow its changes, colors it lacks stay built in
+    if (options.themeFile) {
+        if (watchThemeFile(options.themeFile, &theme.light, &theme.dark))
+            atexit(unwatchThemeFile);
+        if (!loadThemeFile(options.themeFile, &theme.light, &theme.dark))
+            SDL_Log("Failed to load %s: %s", options.themeFile, SDL_GetError());
+    }
+    // Check if dark mode is enabled, and for accent color and contrast
+    if (options.mockAppearance)
+        theme.source = getMockAppearance(options.mockAppearance);
+    else
+        theme.source = getSystemAppearance();
+    if (!options.mockAppearance && watchSystemAppearance())
+        atexit(unwatchSystemAppearance);
+    readAppearance(&theme.source, &theme.settings);
+    updateThemePalette();
+
+    // Create window and renderer
     if (!createWindow())
         return EXIT_FAILURE;
 
+    // Keep the last frames for bug reports
+    if (options.captureRing) {
+        int w, h;
+        SDL_GetWindowSizeInPixels(wnd, &w, &h);
+        if (!initCapture(options.captureRing, w, h))
+            SDL_Log("Failed to set up the capture ring: %s", SDL_GetError());
+    }
+
     // Register hit test
     if (!SDL_SetWindowHitTest(wnd, hitTest, NULL)) {
         SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Failed to enable hit tests",
@@ -89,35 +330,149 @@ int main(void) {
         return EXIT_FAILURE;
     }
 
-    // Load image resources
+    // Upload the image resources, only this has to wait for the renderer
+    start = traceNow();
     loadImageResources();
+    traceSpan("texture upload", start, traceNow());
     // Update the window's layout
+    start = traceNow();
     updateLayout();
-    // Check if dark mode is enabled
-    theme.useLight = SDL_GetSystemTheme() != SDL_SYSTEM_THEME_DARK;
+    traceSpan("layout", start, traceNow());
 
-    // Main update loop
-    SDL_Event event;
-    do {
-        // Redraw window if needed
-        if (windowShouldBeRedrawn) {
-            drawWindow();
-            windowShouldBeRedrawn = false;
+    // Record the session, or replay a recorded one
+    if (options.replayFile)
+        options.recordFile = NULL;
+    layoutInputs inputs;
+    getLayoutInputs(&inputs);
+    if (options.recordFile && !startRecording(options.recordFile, &inputs))
+        SDL_Log("Failed to record to %s: %s", options.recordFile, SDL_GetError());
+    if (options.replayFile) {
+        if (!startReplay(options.replayFile, options.replayRealTime, &replayed.inputs)) {
+            SDL_Log("Failed to replay %s: %s", options.replayFile, SDL_GetError());
+            return EXIT_FAILURE;
         }
+        // Lay out as recorded
+        sizeReplayedWindow();
+        updateLayout();
+    }
 
-        // Wait for unhandled events and handle them
-        /* We need the timeout because otherwise, the app would only react to changes in the system
-         * theme after receiving input, such as mouse movement. Unlike a loop that constantly polls
-         * for unhandled events, this method does not cause a permanent CPU load. */
-        SDL_WaitEventTimeout(&event, 100);
-        handleEvent(&event);
-    } while (!appShouldExit);
+    // Main update loop, fed by the replayed log or the window system
+    eventSource source = getSystemEventSource();
+    if (isReplaying())
+        source = (eventSource){waitForReplayedEvent, NULL, !isRealTimeReplay()};
+    runMainLoop(&source);
+
+    stopRecording();
+    if (options.replayFile) {
+        SDL_Log("Replayed %d hit tests, %d with a different result", replayed.hitTests,
+                replayed.mismatches);
+        if (replayed.mismatches)
+            exitStatus = EXIT_FAILURE;
+    }
+
+    // Report where the startup time went
+    if (options.trace)
+        printTrace();
+    if (options.traceFile && !writeTrace(options.traceFile))
+        SDL_Log("Failed to write trace: %s", SDL_GetError());
+    if (options.stats && !writeStats(options.statsFile))
+        SDL_Log("Failed to write stats to %s: %s",
+                options.statsFile ? options.statsFile : "stdout", SDL_GetError());
 
     // Clean up and exit
-    return EXIT_SUCCESS;
+    return exitStatus;
+}
+
+void parseArguments(int argc, char *argv[]) {
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        char *end;
+
+        if (SDL_strcmp(arg, "--analytic-shadow") == 0) {
+            shadow.analytic = true;
+        } else if (SDL_strncmp(arg, "--font=", 7) == 0) {
+            options.font = arg + 7;
+        } else if (SDL_strcmp(arg, "--no-text") == 0) {
+            options.text = false;
+        } else if (SDL_strcmp(arg, "--stats") == 0) {
+            options.stats = true;
+        } else if (SDL_strncmp(arg, "--stats=", 8) == 0) {
+            options.stats = true;
+            options.statsFile = arg + 8;
+        } else if (SDL_strncmp(arg, "--theme=", 8) == 0) {
+            options.themeFile = arg + 8;
+        } else if (SDL_strncmp(arg, "--record=", 9) == 0) {
+            options.recordFile = arg + 9;
+        } else if (SDL_strncmp(arg, "--replay=", 9) == 0) {
+            options.replayFile = arg + 9;
+        } else if (SDL_strcmp(arg, "--replay-real-time") == 0) {
+            options.replayRealTime = true;
+        } else if (SDL_strncmp(arg, "--capture-ring=", 15) == 0) {
+            options.captureRing = SDL_max(SDL_atoi(arg + 15), 0);
+        } else if (SDL_strncmp(arg, "--mock-appearance=", 18) == 0) {
+            options.mockAppearance = arg + 18;
+        } else if (SDL_strcmp(arg, "--check-palettes") == 0) {
+            // Verify the derived palettes and exit
+            exit(checkPalettes() ? EXIT_SUCCESS : EXIT_FAILURE);
+        } else if (SDL_strncmp(arg, "--theme-fade=", 13) == 0) {
+            // Duration in milliseconds
+            options.themeFade = SDL_strtoul(arg + 13, NULL, 10) * SDL_NS_PER_MS;
+        } else if (SDL_strcmp(arg, "--vsync=on") == 0) {
+            options.vsync = 1;
+        } else if (SDL_strcmp(arg, "--vsync=off") == 0) {
+            options.vsync = SDL_RENDERER_VSYNC_DISABLED;
+        } else if (SDL_strcmp(arg, "--vsync=adaptive") == 0) {
+            options.vsync = SDL_RENDERER_VSYNC_ADAPTIVE;
+        } else if (SDL_strcmp(arg, "--auto-renderer") == 0) {
+            options.autoRenderer = true;
+        } else if (SDL_strcmp(arg, "--check-allocs") == 0) {
+            options.checkAllocs = true;
+        } else if (SDL_strcmp(arg, "--check-loop") == 0) {
+            options.checkLoop = true;
+        } else if (SDL_strcmp(arg, "--bench-edge-to-edge") == 0) {
+            options.benchEdgeToEdge = true;
+        } else if (SDL_strcmp(arg, "--bench-rounded") == 0) {
+            options.benchRounded = true;
+        } else if (SDL_strcmp(arg, "--bench-title") == 0) {
+            options.benchTitle = true;
+        } else if (SDL_strcmp(arg, "--check-regions") == 0) {
+            options.checkRegions = true;
+        } else if (SDL_strcmp(arg, "--edge-to-edge") == 0) {
+            options.edgeToEdge = true;
+        } else if (SDL_strcmp(arg, "--trace") == 0) {
+            options.trace = true;
+        } else if (SDL_strncmp(arg, "--trace=", 8) == 0) {
+            options.traceFile = arg + 8;
+        } else if (SDL_strcmp(arg, "--check-layout") == 0) {
+            // Verify the layout engine for all sizes and scales and exit
+            exit(checkLayouts() ? EXIT_SUCCESS : EXIT_FAILURE);
+        } else if (SDL_strcmp(arg, "--check-shadow") == 0) {
+            // Verify the analytic shadow against a blurred reference and exit
+            exit(checkShadow(&shadow.geometry, timeImageShadow) ? EXIT_SUCCESS : EXIT_FAILURE);
+        } else if (SDL_strncmp(arg, "--shadow-radius=", 16) == 0) {
+            setShadowRadius(SDL_strtod(arg + 16, NULL));
+        } else if (SDL_strncmp(arg, "--shadow-spread=", 16) == 0) {
+            setShadowSpread(SDL_strtod(arg + 16, NULL));
+        } else if (SDL_strncmp(arg, "--shadow-offset=", 16) == 0) {
+            // Offset as x,y
+            float x = SDL_strtod(arg + 16, &end);
+            float y = *end == ',' ? SDL_strtod(end + 1, NULL) : x;
+            setShadowOffset(x, y);
+        } else if (SDL_strncmp(arg, "--shadow-opacity=", 17) == 0) {
+            setShadowOpacity(SDL_strtod(arg + 17, NULL));
+        } else if (SDL_strncmp(arg, "--shadow-color=", 15) == 0) {
+            // Color as RRGGBB
+            Uint32 rgb = SDL_strtoul(arg + 15, NULL, 16);
+            setShadowColor((SDL_Color){rgb >> 16 & 0xff, rgb >> 8 & 0xff, rgb & 0xff, 255});
+        }
+    }
 }
 
 bool initSDL(void) {
+    // Replays and scripted checks run without a window system
+    if (options.replayFile || options.checkLoop)
+        SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "offscreen");
+
     // Init SDL3
     if (!SDL_Init(SDL_INIT_VIDEO)) {
         SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Failed to initialize SDL3",
@@ -126,24 +481,19 @@ bool initSDL(void) {
     }
     atexit(SDL_Quit);
 
-    // Init SDL3_ttf
-    if (!TTF_Init()) {
-        SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR,
-                                 "Failed to initialize SDL3_ttf", SDL_GetError(),
-                                 NULL);
-        return false;
-    }
-    atexit(TTF_Quit);
+    /* SDL3_ttf is initialized lazily together with the title font (see finishStartup), so its
+     * startup cost doesn't delay the first frame */
 
     return true;
 }
 
 bool createWindow(void) {
-    // Create window
+    // Create window, hidden until its first frame is complete
+    Uint64 start = traceNow();
     wnd = SDL_CreateWindow("Demo Window", 800, 600,
                            SDL_WINDOW_HIGH_PIXEL_DENSITY | SDL_WINDOW_RESIZABLE |
                            SDL_WINDOW_BORDERLESS | SDL_WINDOW_TRANSPARENT |
-                           SDL_WINDOW_INPUT_FOCUS);
+                           SDL_WINDOW_INPUT_FOCUS | SDL_WINDOW_HIDDEN);
     if (!wnd) {
         SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Failed to create window",
                                  SDL_GetError(), NULL);
@@ -153,20 +503,38 @@ bool createWindow(void) {
 
     // Set minimum size
     SDL_SetWindowMinimumSize(wnd, 126, 126);
+    traceSpan("window", start, traceNow());
 
-    // Create renderer
-    rnd = SDL_CreateRenderer(wnd, NULL);
+    // Create renderer, with the driver that was fastest on this machine if asked to
+    start = traceNow();
+    rnd = options.autoRenderer ? createTunedRenderer(wnd) : SDL_CreateRenderer(wnd, NULL);
     if (!rnd) {
         SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Failed to create renderer",
                                  SDL_GetError(), NULL);
         return false;
     }
     // rnd will be destroyed by destroyWindow
+    resetRenderState(rnd);
+    initFramePacing(rnd, wnd, options.vsync);
+    traceSpan("renderer", start, traceNow());
 
     return true;
 }
 
 void destroyWindow(void) {
+    // Finish encoding captures
+    quitCapture();
+
+    // Wait for the scale worker, which still reads the shadow images
+    if (scales.worker) {
+        SDL_WaitThread(scales.worker, NULL);
+        scales.worker = NULL;
+    }
+
+    // Destroy text, which uses the renderer
+    destroyTitleText();
+    destroyCursors();
+
     // Destroy renderer
     if (rnd) {
         SDL_DestroyRenderer(rnd);
@@ -180,40 +548,449 @@ void destroyWindow(void) {
     }
 }
 
+void runMainLoop(const eventSource *source) {
+    SDL_Event event;
+    do {
+        // Redraw window if needed, as late as possible before the next vblank
+        if (isRedrawPending() &&
+            (!startupFinished || source->immediate || getFrameDelay() == 0)) {
+            Uint64 start = traceNow();
+            renderFrame();
+            if (!startupFinished) {
+                traceSpan("first frame", start, traceNow());
+                finishStartup();
+                // Verify that the hot loop does not allocate, or how it answers events, and exit
+                checkedApp app = getCheckedApp();
+                if (options.checkAllocs) {
+                    if (!checkSteadyAllocs(&app))
+                        exitStatus = EXIT_FAILURE;
+                    appShouldExit = true;
+                }
+                if (options.checkLoop) {
+                    if (!checkMainLoop(&app))
+                        exitStatus = EXIT_FAILURE;
+                    appShouldExit = true;
+                }
+                if (options.checkRegions) {
+                    if (!checkWindowRegions(wnd, &layout, hitTestLayout))
+                        exitStatus = EXIT_FAILURE;
+                    appShouldExit = true;
+                }
+                if (options.benchEdgeToEdge) {
+                    benchEdgeToEdge(&app);
+                    appShouldExit = true;
+                }
+                if (options.benchRounded) {
+                    benchRoundedChrome(&app);
+                    appShouldExit = true;
+                }
+                // The title benchmark waits for the font
+                if (options.benchTitle && !options.text) {
+                    SDL_Log("The title benchmark needs the title text");
+                    exitStatus = EXIT_FAILURE;
+                    appShouldExit = true;
+                }
+            }
+        }
+
+        // Wait for unhandled events and handle them
+        /* We need the timeout because otherwise, the app would only react to changes in the system
+         * theme after receiving input, such as mouse movement. Unlike a loop that constantly polls
+         * for unhandled events, this method does not cause a permanent CPU load. */
+        Sint32 timeout = 100;
+        if (isRedrawPending())
+            timeout = (getFrameDelay() + SDL_NS_PER_MS - 1) / SDL_NS_PER_MS;
+        if (source->wait(source->data, &event, timeout))
+            handleEvent(&event);
+        else if (!isRedrawPending())
+            recordIdleWakeup();
+    } while (!appShouldExit);
+}
+
+void finishStartup(void) {
+    // Show the window now that its first frame is complete
+    Uint64 start = traceNow();
+    SDL_ShowWindow(wnd);
+    traceSpan("show", start, traceNow());
+
+    startupFinished = true;
+    traceSpan("startup", traceOrigin(), traceNow());
+    // Everything the main loop does outside of layout and drawing is event handling
+    setAllocPhase(ALLOC_EVENT);
+
+    // Now that the window is visible, load the title font in the background
+    if (options.text)
+        loadTitleFont(options.font);
+    // Create the cursors before the pointer needs them
+    prepareCursors();
+
+    // Answer resizes right away from now on
+    SDL_AddEventWatch(watchLiveResize, NULL);
+}
+
 void handleEvent(const SDL_Event *event) {
+    logEvent(event);
+
+    // The title font is ready
+    if (isTitleFontEvent(event)) {
+        bool loaded = finishTitleText(rnd);
+        if (loaded)
+            requestRedraw("font", event->common.timestamp);
+        if (options.benchTitle) {
+            if (loaded) {
+                checkedApp app = getCheckedApp();
+                benchTitleText(&app);
+            } else {
+                SDL_Log("The title benchmark needs a font: %s", SDL_GetError());
+                exitStatus = EXIT_FAILURE;
+            }
+            appShouldExit = true;
+        }
+        return;
+    }
+
+    // The theme file changed, which only affects the chrome's colors
+    if (isThemeFileEvent(event)) {
+        if (takeThemePalettes(&theme.light, &theme.dark)) {
+            updateThemePalette();
+            fadeToTheme();
+            requestRedraw("theme file", event->common.timestamp);
+        }
+        return;
+    }
+
     switch (event->type) {
     case SDL_EVENT_QUIT:
         appShouldExit = true;
         break;
     case SDL_EVENT_WINDOW_EXPOSED:
-        windowShouldBeRedrawn = true;
+        if (event->common.timestamp > live.answered)
+            requestRedraw("expose", event->common.timestamp);
         break;
     case SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED:
-        updateLayout();
+        if (event->common.timestamp > live.answered) {
+            updateLayout();
+            requestRedraw("resize", event->common.timestamp);
+        }
         break;
     case SDL_EVENT_WINDOW_DISPLAY_SCALE_CHANGED:
         updateLayout();
+        requestRedraw("scale", event->common.timestamp);
+        break;
+    case SDL_EVENT_WINDOW_MAXIMIZED:
+    case SDL_EVENT_WINDOW_RESTORED:
+    case SDL_EVENT_WINDOW_ENTER_FULLSCREEN:
+    case SDL_EVENT_WINDOW_LEAVE_FULLSCREEN:
+        // Switch between the floating and the edge-to-edge layout, and the maximize button's icon
+        updateLayout();
+        requestRedraw("window state", event->common.timestamp);
+        break;
+    case SDL_EVENT_RENDER_TARGETS_RESET:
+        // Target textures lost their contents, the copy of the last frame among them
+        resetFrameCopy(false);
+        requestRedraw("render reset", event->common.timestamp);
+        break;
+    case SDL_EVENT_RENDER_DEVICE_RESET:
+        // All textures are gone, and the renderer's state is unknown
+        resetFrameCopy(true);
+        resetRenderState(rnd);
+        requestRedraw("render reset", event->common.timestamp);
+        break;
+    case SDL_EVENT_WINDOW_DISPLAY_CHANGED:
+    case SDL_EVENT_DISPLAY_CURRENT_MODE_CHANGED:
+        updateRefreshRate(wnd);
+        break;
+    case SDL_EVENT_DISPLAY_ADDED:
+    case SDL_EVENT_DISPLAY_REMOVED:
+    case SDL_EVENT_DISPLAY_CONTENT_SCALE_CHANGED:
+        scanDisplays();
+        break;
+    case SDL_EVENT_KEY_DOWN:
+        // Capture the next frame, or save the recorded ones with shift
+        if (event->key.key == SDLK_F12 && !event->key.repeat) {
+            if (event->key.mod & SDL_KMOD_SHIFT) {
+                requestRingDump();
+            } else {
+                requestCapture(NULL);
+                requestRedraw("capture", event->common.timestamp);
+            }
+        }
         break;
     case SDL_EVENT_SYSTEM_THEME_CHANGED:
-        theme.useLight = SDL_GetSystemTheme() != SDL_SYSTEM_THEME_DARK;
-        windowShouldBeRedrawn = true;
+        readAppearance(&theme.source, &theme.settings);
+        updateThemePalette();
+        fadeToTheme();
+        requestRedraw("theme", event->common.timestamp);
+        break;
+    case SDL_EVENT_MOUSE_MOTION:
+    case SDL_EVENT_MOUSE_BUTTON_DOWN:
+    case SDL_EVENT_MOUSE_BUTTON_UP:
+    case SDL_EVENT_WINDOW_MOUSE_LEAVE:
+        handleCaptionEvent(event);
         break;
     }
 }
 
+void handleCaptionEvent(const SDL_Event *event) {
+    // Pointer position in device pixels, like the hit test's
+    SDL_Point pos;
+    captionButton clicked = CAPTION_NONE;
+    Uint32 changed = 0;
+
+    switch (event->type) {
+    case SDL_EVENT_MOUSE_MOTION:
+        pos = (SDL_Point){event->motion.x * layout.scale, event->motion.y * layout.scale};
+        changed = moveCaptionPointer(&layout, &pos);
+        updateCursor(event->motion.x, event->motion.y);
+        break;
+    case SDL_EVENT_MOUSE_BUTTON_DOWN:
+        pos = (SDL_Point){event->button.x * layout.scale, event->button.y * layout.scale};
+        if (event->button.button == SDL_BUTTON_LEFT)
+            changed = pressCaptionButton(&layout, &pos);
+        break;
+    case SDL_EVENT_MOUSE_BUTTON_UP:
+        pos = (SDL_Point){event->button.x * layout.scale, event->button.y * layout.scale};
+        if (event->button.button == SDL_BUTTON_LEFT)
+            changed = releaseCaptionButton(&layout, &pos, &clicked);
+        break;
+    case SDL_EVENT_WINDOW_MOUSE_LEAVE:
+        changed = leaveCaption();
+        break;
+    }
+
+    requestButtonRedraw(changed, event->common.timestamp);
+    if (clicked != CAPTION_NONE)
+        clickCaptionButton(clicked);
+}
+
+void updateCursor(float x, float y) {
+    // Point at the caption buttons, elsewhere show what the hit test lets the pointer do
+    SDL_Point area = {x, y}, pos = {x * layout.scale, y * layout.scale};
+    if (getCaptionButtonAt(&layout, &pos, 0) != CAPTION_NONE)
+        showCursor(SDL_SYSTEM_CURSOR_POINTER);
+    else
+        showCursor(getHitTestCursor(hitTestLayout(&area)));
+}
+
+void clickCaptionButton(captionButton button) {
+    switch (button) {
+    case CAPTION_MINIMIZE:
+        SDL_MinimizeWindow(wnd);
+        break;
+    case CAPTION_MAXIMIZE:
+        if (SDL_GetWindowFlags(wnd) & SDL_WINDOW_MAXIMIZED)
+            SDL_RestoreWindow(wnd);
+        else
+            SDL_MaximizeWindow(wnd);
+        break;
+    case CAPTION_CLOSE:
+        appShouldExit = true;
+        break;
+    default:
+        break;
+    }
+}
+
+bool waitForReplayedEvent(void *data, SDL_Event *event, Sint32 timeout) {
+    // Events SDL sends itself, such as for the replayed resizes, come first
+    if (SDL_PollEvent(event))
+        return true;
+
+    logEntry entry;
+    Uint64 wait;
+    while (readLogEntry(&entry, &wait)) {
+        if (entry.kind == LOG_HIT_TEST) {
+            replayHitTest(&entry);
+            continue;
+        }
+        if (entry.kind == LOG_LAYOUT) {
+            replayed.inputs = entry.layout;
+            sizeReplayedWindow();
+            updateLayout();
+            if (SDL_PollEvent(event))
+                return true;
+            continue;
+        }
+
+        // Replayed events happen now, to this window
+        *event = entry.event;
+        event->common.timestamp = traceNow();
+        if (event->type >= SDL_EVENT_WINDOW_FIRST && event->type <= SDL_EVENT_WINDOW_LAST)
+            event->window.windowID = SDL_GetWindowID(wnd);
+
+        /* Resizes are in points, which differ between displays. The layout entry that follows
+         * resizes the window in pixels instead, which makes SDL send the size events for it. */
+        if (event->type == SDL_EVENT_WINDOW_RESIZED ||
+            event->type == SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED)
+            continue;
+
+        // Apply window state changes too, the replayed event lays out the window for them
+        switch (event->type) {
+        case SDL_EVENT_WINDOW_MAXIMIZED:
+            replayed.inputs.state |= SDL_WINDOW_MAXIMIZED;
+            SDL_MaximizeWindow(wnd);
+            break;
+        case SDL_EVENT_WINDOW_RESTORED:
+            replayed.inputs.state &= ~SDL_WINDOW_MAXIMIZED;
+            SDL_RestoreWindow(wnd);
+            break;
+        case SDL_EVENT_WINDOW_ENTER_FULLSCREEN:
+            replayed.inputs.state |= SDL_WINDOW_FULLSCREEN;
+            SDL_SetWindowFullscreen(wnd, true);
+            break;
+        case SDL_EVENT_WINDOW_LEAVE_FULLSCREEN:
+            replayed.inputs.state &= ~SDL_WINDOW_FULLSCREEN;
+            SDL_SetWindowFullscreen(wnd, false);
+            break;
+        }
+        return true;
+    }
+
+    // Wait for the next entry in real time, or end with the log
+    if (wait) {
+        Sint32 ms = (wait + SDL_NS_PER_MS - 1) / SDL_NS_PER_MS;
+        return SDL_WaitEventTimeout(event, SDL_min(timeout, ms));
+    }
+    stopReplay();
+    appShouldExit = true;
+    return false;
+}
+
+void sizeReplayedWindow(void) {
+    // The recorded size in pixels, so the replay draws the same
+    int w, h;
+    SDL_GetWindowSizeInPixels(wnd, &w, &h);
+    if (w == replayed.inputs.w && h == replayed.inputs.h)
+        return;
+    float density = SDL_GetWindowPixelDensity(wnd);
+    SDL_SetWindowSize(wnd, SDL_lroundf(replayed.inputs.w / density),
+                      SDL_lroundf(replayed.inputs.h / density));
+}
+
+void replayHitTest(const logEntry *entry) {
+    replayed.hitTests++;
+    if ((int)hitTestLayout(&entry->point) != entry->result) {
+        SDL_Log("Hit test at %d, %d returned %d instead of %d", entry->point.x, entry->point.y,
+                hitTestLayout(&entry->point), entry->result);
+        replayed.mismatches++;
+    }
+}
+
+bool SDLCALL watchLiveResize(void *data, SDL_Event *event) {
+    if (event->type != SDL_EVENT_WINDOW_EXPOSED &&
+        event->type != SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED)
+        return true;
+
+    // The renderer may only be used from the main thread, and not while it's already drawing
+    if (live.rendering || !SDL_IsMainThread() || event->window.windowID != SDL_GetWindowID(wnd))
+        return true;
+
+    // Lay out the new size right away, so the frame for it can be drawn whenever it's due
+    if (event->type == SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED) {
+        updateLayout();
+        requestRedraw("resize", event->common.timestamp);
+    } else {
+        requestRedraw("expose", event->common.timestamp);
+    }
+    live.answered = event->common.timestamp;
+
+    /* SDL marks the exposes it sends from the modal size loop, where the main loop can't draw
+     * until the resize ends. Any other time the frame is left to the main loop's pacing. */
+    if (event->type == SDL_EVENT_WINDOW_EXPOSED && event->window.data1)
+        renderFrame();
+    return true;
+}
+
+checkedApp getCheckedApp(void) {
+    // The checks drive the app through its own functions
+    return (checkedApp){
+        .window = wnd,
+        .renderer = rnd,
+        .layout = &layout,
+        .palette = &theme.active,
+        .vsync = options.vsync,
+        .edgeToEdge = options.edgeToEdge,
+        .shadowOpacity = shadow.opacity,
+        .themeFade = options.themeFade,
+        .captureRing = options.captureRing > 0,
+        .updateLayout = updateLayout,
+        .drawWindow = drawWindow,
+        .redraw = redrawNow,
+        .runMainLoop = runScriptedLoop,
+        .watchLiveResize = watchLiveResize,
+        .drawChrome = drawChrome,
+        .setEdgeToEdge = setEdgeToEdge,
+        .setShadowOpacity = setShadowOpacity,
+        .setThemeFade = setThemeFade
+    };
+}
+
+void redrawNow(void) {
+    windowShouldBeRedrawn = true;
+    renderFrame();
+}
+
+void runScriptedLoop(const eventSource *source) {
+    // The script quits the loop when it ends, which mustn't quit the app
+    runMainLoop(source);
+    appShouldExit = false;
+}
+
+Uint64 drawChrome(bool rounded) {
+    // Only the chrome, filled the way drawWindow() does it
+    Uint64 draws = corners.draws;
+    const palette *p = &theme.active;
+    setRenderTarget(NULL);
+    setDrawBlendMode(SDL_BLENDMODE_NONE);
+    setDrawColor((SDL_Color){0, 0, 0, 0});
+    SDL_RenderClear(rnd);
+    drawRoundedRect(&layout.background, p->border, &corners.outer, rounded, rounded);
+    drawRoundedRect(&layout.titleBar, p->titleBar, &corners.inner, rounded, false);
+    drawRoundedRect(&layout.clientArea, p->background, &corners.inner, false, rounded);
+    SDL_RenderPresent(rnd);
+    return corners.draws - draws;
+}
+
+void setEdgeToEdge(bool edgeToEdge) {
+    options.edgeToEdge = edgeToEdge;
+    updateLayout();
+}
+
+void setThemeFade(Uint64 duration) {
+    options.themeFade = duration;
+}
+
 SDL_HitTestResult hitTest(SDL_Window *win, const SDL_Point *area, void *data) {
-    float scale = layout.scale;
+    Uint64 start = traceNow();
+    SDL_HitTestResult result = hitTestLayout(area);
+    recordHitTest(traceNow() - start);
+    logHitTest(area, result);
+    return result;
+}
 
+SDL_HitTestResult hitTestLayout(const SDL_Point *area) {
     // Shortcut for background position and size
-    float bx = layout.background.x, by = layout.background.y,
+    int bx = layout.background.x, by = layout.background.y,
             bw = layout.background.w, bh = layout.background.h;
-    // Cursor position as float
-    SDL_FPoint pos = {area->x * scale, area->y * scale};
-    // Cursor position as int
+    // Cursor position in device pixels
+    SDL_Point pos = {area->x * layout.scale, area->y * layout.scale};
     int x = pos.x, y = pos.y;
 
     // Tolerances
-    int edgeTol = ceilf(2 * scale), cornerTol = ceilf(8 * scale);
+    int edgeTol = layout.metrics.edgeTol, cornerTol = layout.metrics.cornerTol;
+
+    // Edge-to-edge windows can't be resized, so they have no borders to grab
+    if (layout.edgeToEdge) {
+        if (getCaptionButtonAt(&layout, &pos, 0) != CAPTION_NONE)
+            return SDL_HITTEST_NORMAL;
+        if (SDL_PointInRect(&pos, &layout.titleBar))
+            return SDL_HITTEST_DRAGGABLE;
+        return SDL_HITTEST_NORMAL;
+    }
+
+    // The shadow margin beyond the borders' tolerance takes no input
+    if (x < bx - edgeTol || x > bx + bw + edgeTol || y < by - edgeTol || y > by + bh + edgeTol)
+        return SDL_HITTEST_NORMAL;
 
     // Left border
     if (x >= bx - edgeTol && x <= bx + edgeTol) {
@@ -243,45 +1020,208 @@ SDL_HitTestResult hitTest(SDL_Window *win, const SDL_Point *area, void *data) {
         return SDL_HITTEST_RESIZE_BOTTOM;
     }
 
+    // Caption buttons, which the app handles itself
+    else if (getCaptionButtonAt(&layout, &pos, 0) != CAPTION_NONE) {
+        return SDL_HITTEST_NORMAL;
+    }
+
     // Title bar
-    else if (SDL_PointInRectFloat(&pos, &layout.titleBar)) {
+    else if (SDL_PointInRect(&pos, &layout.titleBar)) {
         return SDL_HITTEST_DRAGGABLE;
     }
 
     return SDL_HITTEST_NORMAL;
 }
 
-void drawWindow(void) {
-    // Clear with transparent black
-    SDL_SetRenderDrawColor(rnd, 0, 0, 0, 0);
-    SDL_RenderClear(rnd);
+void requestRedraw(const char *cause, Uint64 timestamp) {
+    windowShouldBeRedrawn = true;
+    addRedrawCause(cause, timestamp);
+}
 
-    // Draw shadow
-    drawShadow();
+void requestButtonRedraw(Uint32 buttons, Uint64 timestamp) {
+    if (!buttons)
+        return;
+    captionButtons.damaged |= buttons;
+    addRedrawCause("caption", timestamp);
+}
+
+void addRedrawCause(const char *cause, Uint64 timestamp) {
+    // Only the first event of each kind is measured, later ones wait less for the same frame
+    for (int i = 0; i < pendingRedraw.count; i++) {
+        if (SDL_strcmp(pendingRedraw.causes[i], cause) == 0)
+            return;
+    }
+    if (pendingRedraw.count < (int)SDL_arraysize(pendingRedraw.causes)) {
+        pendingRedraw.causes[pendingRedraw.count] = cause;
+        pendingRedraw.times[pendingRedraw.count] = timestamp;
+        pendingRedraw.count++;
+    }
+}
+
+bool isRedrawPending(void) {
+    return windowShouldBeRedrawn || captionButtons.damaged;
+}
+
+void renderFrame(void) {
+    live.rendering = true;
+    Uint64 start = traceNow();
+    beginFrame();
+    if (windowShouldBeRedrawn) {
+        drawWindow(NULL);
+    } else if (drawDamage()) {
+        recordPartialFrame();
+    }
+    finishFrame();
+    windowShouldBeRedrawn = false;
+    captionButtons.damaged = 0;
+    recordFrame(traceNow() - start);
+    // Keep drawing until a fade is done, paced like any other redraw
+    if (isPaletteFading())
+        windowShouldBeRedrawn = true;
+
+    // Measure how long the events shown by this frame waited for it
+    Uint64 end = traceNow();
+    for (int i = 0; i < pendingRedraw.count; i++) {
+        recordLatency(pendingRedraw.causes[i], end - pendingRedraw.times[i]);
+        traceFlow(pendingRedraw.causes[i], pendingRedraw.times[i], end);
+    }
+    pendingRedraw.count = 0;
+    live.rendering = false;
+}
+
+void drawWindow(SDL_Texture *target) {
+    allocPhase phase = setAllocPhase(ALLOC_DRAW);
+
+    // Draw onto the window or its copy, overwriting what's there, and clear with transparent black
+    setRenderTarget(target);
+    setDrawBlendMode(SDL_BLENDMODE_NONE);
+
+    // Only a floating window has transparent pixels, an edge-to-edge one is covered by its chrome
+    if (!layout.edgeToEdge) {
+        setDrawColor((SDL_Color){0, 0, 0, 0});
+        SDL_RenderClear(rnd);
+        drawShadow();
+    }
+
+    // Colors of the theme, or of the current frame of a fade to it
+    palette *p = &theme.shown;
+    if (!getFadePalette(traceNow(), p))
+        *p = theme.active;
 
     // Draw background border and client area
-    SDL_Color c;
+    // Corners are only rounded while floating
+    bool round = !layout.edgeToEdge;
+    drawRoundedRect(&layout.background, p->border, &corners.outer, round, round);
+    drawRoundedRect(&layout.titleBar, p->titleBar, &corners.inner, round, false);
+
+    // Draw the window title, which is only reshaped if it or the scale changed
+    updateTitleText(SDL_GetWindowTitle(wnd), layout.scale);
+    drawTitleText(&layout.titleText, p->text);
+
+    // Draw the caption buttons in their current state
+    bool maximized = SDL_GetWindowFlags(wnd) & SDL_WINDOW_MAXIMIZED;
+    for (int i = 0; i < CAPTION_BUTTONS; i++) {
+        drawCaptionButton(rnd, captionButtons.icons, &layout.buttons[i], i, maximized,
+                          p->text);
+    }
+
+    drawRoundedRect(&layout.clientArea, p->background, &corners.inner, false, round);
+
+    presentFrame(target);
+    // A frame drawn straight to the window leaves the copy behind
+    captionButtons.current = target != NULL;
+    setAllocPhase(phase);
+}
 
-    c = theme.useLight ? theme.light.border : theme.dark.border;
-    SDL_SetRenderDrawColor(rnd, c.r, c.g, c.b, c.a);
-    SDL_RenderFillRect(rnd, &layout.background);
+bool drawDamage(void) {
+    /* The buttons are drawn over a copy of the last frame. After a full frame the copy is drawn
+     * in full once, without one everything is redrawn on the window */
+    if (!captionButtons.current) {
+        reserveFrameCopy();
+        drawWindow(captionButtons.frame);
+        return false;
+    }
+
+    allocPhase phase = setAllocPhase(ALLOC_DRAW);
+    setRenderTarget(captionButtons.frame);
+    setDrawBlendMode(SDL_BLENDMODE_NONE);
+
+    // Repaint the title bar behind each damaged button, then the button itself
+    const palette *p = &theme.shown;
+    bool maximized = SDL_GetWindowFlags(wnd) & SDL_WINDOW_MAXIMIZED;
+    for (int i = 0; i < CAPTION_BUTTONS; i++) {
+        if (!(captionButtons.damaged & 1u << i))
+            continue;
+        const SDL_Rect *rect = &layout.buttons[i];
+        SDL_FRect area = {rect->x, rect->y, rect->w, rect->h};
+        setClipRect(rect);
+        setDrawColor(p->titleBar);
+        SDL_RenderFillRect(rnd, &area);
+        drawCaptionButton(rnd, captionButtons.icons, rect, i, maximized, p->text);
+    }
+    setClipRect(NULL);
+
+    presentFrame(captionButtons.frame);
+    setAllocPhase(phase);
+    return true;
+}
 
-    c = theme.useLight ? theme.light.titleBar : theme.dark.titleBar;
-    SDL_SetRenderDrawColor(rnd, c.r, c.g, c.b, c.a);
-    SDL_RenderFillRect(rnd, &layout.titleBar);
+void presentFrame(SDL_Texture *copy) {
+    // Show the copy of the frame, if it was drawn there
+    if (copy) {
+        SDL_FRect area = {0, 0, layout.window.w, layout.window.h};
+        setRenderTarget(NULL);
+        SDL_RenderTexture(rnd, copy, &area, &area);
+    }
 
-    c = theme.useLight ? theme.light.background : theme.dark.background;
-    SDL_SetRenderDrawColor(rnd, c.r, c.g, c.b, c.a);
-    SDL_RenderFillRect(rnd, &layout.clientArea);
+    // Read back the frame if a capture or the ring wants it
+    captureFrame(rnd);
 
     // Swap buffers
+    markFrameSubmitted();
+    setAllocPhase(ALLOC_PRESENT);
     SDL_RenderPresent(rnd);
 }
 
+void reserveFrameCopy(void) {
+    int w = layout.window.w, h = layout.window.h;
+    if (captionButtons.frame && w <= captionButtons.frameW && h <= captionButtons.frameH)
+        return;
+
+    // Grow in steps of 256 pixels
+    resetFrameCopy(true);
+    captionButtons.frameW = (SDL_max(w, captionButtons.frameW) + 255) / 256 * 256;
+    captionButtons.frameH = (SDL_max(h, captionButtons.frameH) + 255) / 256 * 256;
+    captionButtons.frame = SDL_CreateTexture(rnd, SDL_PIXELFORMAT_ARGB8888,
+                                             SDL_TEXTUREACCESS_TARGET, captionButtons.frameW,
+                                             captionButtons.frameH);
+    if (captionButtons.frame) {
+        SDL_SetTextureBlendMode(captionButtons.frame, SDL_BLENDMODE_NONE);
+        SDL_SetTextureScaleMode(captionButtons.frame, SDL_SCALEMODE_NEAREST);
+    }
+}
+
+void resetFrameCopy(bool lost) {
+    // The copy no longer holds the last frame, and without its texture it's created again
+    captionButtons.current = false;
+    if (lost && captionButtons.frame) {
+        forgetTextureState(captionButtons.frame);
+        SDL_DestroyTexture(captionButtons.frame);
+        captionButtons.frame = NULL;
+    }
+}
+
 void drawShadow(void) {
+    if (shadow.analytic) {
+        drawAnalyticShadow();
+        return;
+    }
+
     int w = layout.window.w, h = layout.window.h;
+    // Corner size and edge thickness of the images
+    float n = shadow.corner->w, m = shadow.margin;
 
-    SDL_FRect dest = {0, 0, 55, 55};
+    SDL_FRect dest = {0, 0, n, n};
 
     // Corners
 
@@ -303,82 +1243,712 @@ void drawShadow(void) {
     // Sides
 
     // Top
-    dest.x = 55;
+    dest.x = n;
     dest.y = 0;
-    dest.w = w - 110;
-    dest.h = 16;
+    dest.w = w - 2 * n;
+    dest.h = m;
     SDL_RenderTextureRotated(rnd, shadow.bottom, NULL, &dest, 0, NULL,
                              SDL_FLIP_VERTICAL);
 
     // Bottom
-    dest.y = h - 16;
+    dest.y = h - m;
     SDL_RenderTexture(rnd, shadow.bottom, NULL, &dest);
 
     // Left
     dest.x = 0;
-    dest.y = 55;
-    dest.w = 16;
-    dest.h = h - 110;
+    dest.y = n;
+    dest.w = m;
+    dest.h = h - 2 * n;
     SDL_RenderTextureRotated(rnd, shadow.left, NULL, &dest, 0, NULL,
                              SDL_FLIP_NONE);
 
     // Right
-    dest.x = w - 16;
+    dest.x = w - m;
     SDL_RenderTextureRotated(rnd, shadow.left, NULL, &dest, 0, NULL,
                              SDL_FLIP_HORIZONTAL);
 }
 
+void drawAnalyticShadow(void) {
+    float w = layout.window.w, h = layout.window.h;
+    float n = shadow.atlas.size, m = shadow.atlas.margin;
+    SDL_FRect src;
+
+    /* Pieces that are larger than half the window, with large blurs or small windows, are cut
+     * to their outer part, so opposite ones neither overlap nor leave strips of negative size */
+    float cx = SDL_min(n, w / 2), cy = SDL_min(n, h / 2);
+    float mx = SDL_min(m, w / 2), my = SDL_min(m, h / 2);
+
+    // Corners, stored in the orientation they are drawn in
+    SDL_FRect corners[4] = {{0, 0, cx, cy}, {w - cx, 0, cx, cy}, {0, h - cy, cx, cy},
+                            {w - cx, h - cy, cx, cy}};
+    for (int i = 0; i < 4; i++) {
+        SDL_RectToFRect(&shadow.atlas.corners[i], &src);
+        src.x += i % 2 ? n - cx : 0;
+        src.y += i / 2 ? n - cy : 0;
+        src.w = cx;
+        src.h = cy;
+        SDL_RenderTexture(rnd, shadow.texture, &src, &corners[i]);
+    }
+
+    // Edges, stretched from one pixel wide profiles
+    SDL_FRect edges[4] = {{cx, 0, w - 2 * cx, my}, {cx, h - my, w - 2 * cx, my},
+                          {0, cy, mx, h - 2 * cy}, {w - mx, cy, mx, h - 2 * cy}};
+    for (int i = 0; i < 4; i++) {
+        if (edges[i].w <= 0 || edges[i].h <= 0)
+            continue;
+        SDL_RectToFRect(&shadow.atlas.edges[i], &src);
+        if (i < 2) {
+            src.y += i ? m - my : 0;
+            src.h = my;
+        } else {
+            src.x += i == 3 ? m - mx : 0;
+            src.w = mx;
+        }
+        SDL_RenderTexture(rnd, shadow.texture, &src, &edges[i]);
+    }
+}
+
+void drawRoundedRect(const SDL_Rect *rect, SDL_Color c, const SDL_FRect *tile,
+                     bool top, bool bottom) {
+    float x = rect->x, y = rect->y, w = rect->w, h = rect->h;
+    float r = tile->w;
+    float t = top ? r : 0, b = bottom ? r : 0;
+
+    /* Fill the center column and the two side columns between the rounded corners. Together
+     * with the corner tiles they cover exactly the area of the square rect, so rounding the
+     * chrome doesn't add any fill work. */
+    SDL_FRect fill[3] = {
+        {x + r, y, w - 2 * r, h},
+        {x, y + t, r, h - t - b},
+        {x + w - r, y + t, r, h - t - b}
+    };
+    setDrawColor(c);
+    SDL_RenderFillRects(rnd, fill, 3);
+    corners.draws++;
+
+    // Tint the cached coverage mask with the fill color
+    setTextureTint(corners.mask, c.r, c.g, c.b, c.a / 255.0f);
+
+    // Top corners
+    SDL_FRect dest = {x, y, r, r};
+    if (top) {
+        SDL_RenderTexture(rnd, corners.mask, tile, &dest);
+        dest.x = x + w - r;
+        SDL_RenderTextureRotated(rnd, corners.mask, tile, &dest, 0, NULL,
+                                 SDL_FLIP_HORIZONTAL);
+        corners.draws += 2;
+    }
+
+    // Bottom corners
+    if (bottom) {
+        dest.x = x;
+        dest.y = y + h - r;
+        SDL_RenderTextureRotated(rnd, corners.mask, tile, &dest, 0, NULL,
+                                 SDL_FLIP_VERTICAL);
+        dest.x = x + w - r;
+        SDL_RenderTextureRotated(rnd, corners.mask, tile, &dest, 0, NULL,
+                                 SDL_FLIP_HORIZONTAL | SDL_FLIP_VERTICAL);
+        corners.draws += 2;
+    }
+}
+
+void startAssetPreparation(void) {
+    initScales();
+    shadow.decoded = SDL_CreateSemaphore(0);
+
+    // Add the scales of all displays, so the worker prepares the window's scale right away
+    addDisplayScales();
+
+    scales.working = true;
+    scales.worker = SDL_CreateThread(prepareAssets, "assets", NULL);
+    if (!scales.worker) {
+        // Do it on the main thread instead
+        scales.working = false;
+        decodeImageResources();
+    }
+}
+
+int prepareAssets(void *data) {
+    // Decode the images, then go on with the pixels of every display scale
+    decodeImageResources();
+    return prepareScales(data);
+}
+
+void decodeImageResources(void) {
+    // The analytic shadow doesn't need any images
+    if (!shadow.analytic) {
+        Uint64 start = traceNow();
+        shadow.cornerSource = loadShadowImage(corner_png, corner_png_len);
+        shadow.bottomSource = loadShadowImage(bottom_png, bottom_png_len);
+        shadow.leftSource = loadShadowImage(left_png, left_png_len);
+        traceSpan("image decode", start, traceNow());
+
+        // The margin is as wide as the shadow's sides
+        shadow.margin = shadow.leftSource->w;
+    }
+
+    SDL_SignalSemaphore(shadow.decoded);
+}
+
 void loadImageResources(void) {
-    // Load shadow textures
-    shadow.corner = IMG_LoadTextureTyped_IO(
-                rnd, SDL_IOFromMem(corner_png, corner_png_len), true, "png");
-    shadow.bottom = IMG_LoadTextureTyped_IO(
-                rnd, SDL_IOFromMem(bottom_png, bottom_png_len), true, "png");
-    shadow.left = IMG_LoadTextureTyped_IO(
-                rnd, SDL_IOFromMem(left_png, left_png_len), true, "png");
+    // Wait until the images have been decoded in the background
+    SDL_WaitSemaphore(shadow.decoded);
+
+    // The analytic shadow doesn't need any images
+    if (shadow.analytic)
+        return;
+
+    // Upload the sides, the corner is uploaded per scale (see getScaleResources)
+    shadow.bottom = SDL_CreateTextureFromSurface(rnd, shadow.bottomSource);
+    shadow.left = SDL_CreateTextureFromSurface(rnd, shadow.leftSource);
+    SDL_DestroySurface(shadow.bottomSource);
+    SDL_DestroySurface(shadow.leftSource);
+    shadow.bottomSource = NULL;
+    shadow.leftSource = NULL;
 
-    // Set shadow intensity
-    SDL_SetTextureAlphaModFloat(shadow.corner, 0.3);
-    SDL_SetTextureAlphaModFloat(shadow.bottom, 0.3);
-    SDL_SetTextureAlphaModFloat(shadow.left, 0.3);
+    // Set shadow color and intensity
+    applyShadowTint();
 }
 
 void updateLayout(void) {
-    // Get content scale
-    float scale = SDL_GetWindowDisplayScale(wnd);
-    layout.scale = scale;
+    allocPhase phase = setAllocPhase(ALLOC_LAYOUT);
 
-    // Update window size
-    int w, h;
-    SDL_GetWindowSizeInPixels(wnd, &w, &h);
-    layout.window.x = 0;
-    layout.window.y = 0;
-    layout.window.w = w;
-    layout.window.h = h;
-
-    // Update background area without shadows
-    layout.background.x = shadow.left->w;
-    layout.background.y = shadow.bottom->h;
-    layout.background.w = w - 2 * shadow.left->w;
-    layout.background.h = h - 2 * shadow.bottom->h;
-
-    // Remaining height for client area
-    float rh = layout.background.h - 2 * floorf(scale);
-
-    // Update title area
-    layout.titleBar.x = layout.background.x + floorf(scale);
-    layout.titleBar.y = layout.background.y + floorf(scale);
-    layout.titleBar.w = layout.background.w - 2 * floorf(scale);
-    layout.titleBar.h = ceilf(30 * scale);
-
-    rh -= (layout.titleBar.h + floorf(scale));
-
-    // Update client area
-    layout.clientArea.x = layout.titleBar.x;
-    layout.clientArea.y = layout.titleBar.y + layout.titleBar.h + floorf(scale);
-    layout.clientArea.w = layout.titleBar.w;
-    layout.clientArea.h = rh;
+    // Get content scale, size and state, and keep them for a replay
+    layoutInputs inputs;
+    getLayoutInputs(&inputs);
+    logLayout(&inputs);
+    layout.scale = inputs.scale;
+
+    // Swap in the constants and resources for this scale
+    activateScale(getScaleResources(inputs.scale));
+
+    // Maximized and fullscreen windows have no room for a shadow around them
+    layout.edgeToEdge = options.edgeToEdge || inputs.state;
+
+    // Compute the layout in device pixels
+    computeLayout(&layout, inputs.w, inputs.h, layout.edgeToEdge ? 0 : shadow.margin);
+    recordLayout();
+
+    // Tell the compositor which parts are opaque and which take input
+    applyWindowRegions(wnd, &layout);
 
     // Mark window as dirty
     windowShouldBeRedrawn = true;
+    setAllocPhase(phase);
+}
+
+void getLayoutInputs(layoutInputs *inputs) {
+    // A replay lays out like the recorded window
+    if (isReplaying()) {
+        *inputs = replayed.inputs;
+        return;
+    }
+    inputs->scale = SDL_GetWindowDisplayScale(wnd);
+    SDL_GetWindowSizeInPixels(wnd, &inputs->w, &inputs->h);
+    inputs->state = SDL_GetWindowFlags(wnd) & (SDL_WINDOW_MAXIMIZED | SDL_WINDOW_FULLSCREEN);
+}
+
+void initScales(void) {
+    scales.mutex = SDL_CreateMutex();
+    scales.built = SDL_CreateCondition();
+    scales.geometry = shadow.geometry;
+}
+
+void scanDisplays(void) {
+    addDisplayScales();
+
+    // Build the missing pixels in the background
+    startScaleWorker();
+}
+
+void addDisplayScales(void) {
+    int count;
+    SDL_DisplayID *displays = SDL_GetDisplays(&count);
+    if (!displays)
+        return;
+
+    SDL_LockMutex(scales.mutex);
+
+    /* Make sure there's an entry for every distinct scale. This assumes that the window's display
+     * scale on a display matches its content scale; if it doesn't, the resources are simply
+     * built on demand when the window arrives there. */
+    bool needed[SDL_arraysize(scales.entries)] = {false};
+    for (int i = 0; i < count; i++) {
+        float scale = SDL_GetDisplayContentScale(displays[i]);
+        if (scale <= 0)
+            continue;
+
+        scaleResources *res = findScale(scale);
+        if (!res)
+            res = addScale(scale);
+        if (res)
+            needed[res - scales.entries] = true;
+    }
+
+    // Drop the resources of scales that aren't used by any display anymore
+    for (size_t i = 0; i < SDL_arraysize(scales.entries); i++) {
+        scaleResources *res = &scales.entries[i];
+        if (res->used && !needed[i] && !res->building && res->scale != layout.scale)
+            releaseScale(res);
+    }
+
+    SDL_UnlockMutex(scales.mutex);
+    SDL_free(displays);
+}
+
+void startScaleWorker(void) {
+    SDL_LockMutex(scales.mutex);
+    bool working = scales.working;
+    SDL_UnlockMutex(scales.mutex);
+
+    // A running worker picks up new entries by itself
+    if (working)
+        return;
+    if (scales.worker)
+        SDL_WaitThread(scales.worker, NULL);
+
+    scales.working = true;
+    scales.worker = SDL_CreateThread(prepareScales, "scales", NULL);
+    if (!scales.worker)
+        scales.working = false;
+}
+
+int prepareScales(void *data) {
+    for (;;) {
+        SDL_LockMutex(scales.mutex);
+
+        // Find an entry whose pixels are missing or outdated
+        int generation = scales.generation;
+        scaleResources *res = NULL;
+        for (size_t i = 0; i < SDL_arraysize(scales.entries); i++) {
+            scaleResources *e = &scales.entries[i];
+            if (e->used && !e->building && e->pixelGeneration != generation &&
+                    e->textureGeneration != generation)
+                res = e;
+        }
+        if (!res) {
+            scales.working = false;
+            SDL_UnlockMutex(scales.mutex);
+            return 0;
+        }
+
+        // Build outside of the lock, so the main thread is never blocked by it
+        res->building = true;
+        shadowGeometry geometry = scales.geometry;
+        scaleResources built = *res;
+        SDL_UnlockMutex(scales.mutex);
+
+        Uint64 start = traceNow();
+        bool ok = buildScalePixels(&built, &geometry);
+        traceSpan("scale pixels", start, traceNow());
+
+        SDL_LockMutex(scales.mutex);
+        res->building = false;
+        // Keep the result unless the main thread was faster or the geometry changed meanwhile
+        if (ok && generation == scales.generation && res->pixelGeneration != generation &&
+                res->textureGeneration != generation) {
+            storeScalePixels(res, &built, generation);
+        } else {
+            SDL_DestroySurface(built.maskPixels);
+            SDL_DestroySurface(built.shadowPixels);
+            SDL_DestroySurface(built.iconPixels);
+        }
+        // Wake up the main thread if it's waiting for this entry
+        SDL_BroadcastCondition(scales.built);
+        SDL_UnlockMutex(scales.mutex);
+    }
+}
+
+scaleResources *getScaleResources(float scale) {
+    SDL_LockMutex(scales.mutex);
+
+    scaleResources *res = findScale(scale);
+    if (!res)
+        res = addScale(scale);
+    // Only possible if the worker is busy with all eight entries
+    if (!res) {
+        SDL_UnlockMutex(scales.mutex);
+        return &scales.entries[0];
+    }
+
+    int generation = scales.generation;
+    if (res->textureGeneration == generation) {
+        SDL_UnlockMutex(scales.mutex);
+        return res;
+    }
+
+    // Wait if the worker is already building the pixels, instead of building them twice
+    while (res->building)
+        SDL_WaitCondition(scales.built, scales.mutex);
+
+    // The pixels aren't ready yet, so build them right away, and keep the worker off the entry
+    if (res->pixelGeneration != generation) {
+        res->building = true;
+        scaleResources built = *res;
+        shadowGeometry geometry = scales.geometry;
+        SDL_UnlockMutex(scales.mutex);
+        bool ok = buildScalePixels(&built, &geometry);
+        SDL_LockMutex(scales.mutex);
+        res->building = false;
+
+        if (ok)
+            storeScalePixels(res, &built, generation);
+    }
+
+    // Take the pixels, the worker doesn't touch entries with current pixels
+    SDL_Surface *maskPixels = res->maskPixels, *shadowPixels = res->shadowPixels;
+    SDL_Surface *iconPixels = res->iconPixels;
+    res->maskPixels = NULL;
+    res->shadowPixels = NULL;
+    res->iconPixels = NULL;
+    SDL_UnlockMutex(scales.mutex);
+
+    // Upload them
+    forgetTextureState(res->mask);
+    forgetTextureState(res->shadow);
+    if (res->mask)
+        SDL_DestroyTexture(res->mask);
+    if (res->shadow)
+        SDL_DestroyTexture(res->shadow);
+    res->mask = SDL_CreateTextureFromSurface(rnd, maskPixels);
+    res->shadow = SDL_CreateTextureFromSurface(rnd, shadowPixels);
+    SDL_SetTextureScaleMode(res->mask, SDL_SCALEMODE_NEAREST);
+    /* The edge profiles of the atlas are stretched along the window, so sampling must not bleed
+     * into the neighboring pieces */
+    if (shadow.analytic)
+        SDL_SetTextureScaleMode(res->shadow, SDL_SCALEMODE_NEAREST);
+    // The icons only depend on the scale, so they're kept when just the shadow changed
+    if (iconPixels) {
+        forgetTextureState(res->icons);
+        if (res->icons)
+            SDL_DestroyTexture(res->icons);
+        res->icons = SDL_CreateTextureFromSurface(rnd, iconPixels);
+    }
+    SDL_DestroySurface(maskPixels);
+    SDL_DestroySurface(shadowPixels);
+    SDL_DestroySurface(iconPixels);
+    res->textureGeneration = generation;
+
+    return res;
+}
+
+scaleResources *findScale(float scale) {
+    for (size_t i = 0; i < SDL_arraysize(scales.entries); i++) {
+        if (scales.entries[i].used && scales.entries[i].scale == scale)
+            return &scales.entries[i];
+    }
+    return NULL;
+}
+
+scaleResources *addScale(float scale) {
+    // Take a free entry or else one that is neither active nor being built
+    scaleResources *res = NULL;
+    for (size_t i = 0; i < SDL_arraysize(scales.entries) && !res; i++) {
+        if (!scales.entries[i].used)
+            res = &scales.entries[i];
+    }
+    for (size_t i = 0; i < SDL_arraysize(scales.entries) && !res; i++) {
+        scaleResources *e = &scales.entries[i];
+        if (!e->building && e->scale != layout.scale)
+            res = e;
+    }
+    if (!res)
+        return NULL;
+    releaseScale(res);
+
+    // Layout constants
+    res->used = true;
+    res->scale = scale;
+    res->metrics = getLayoutMetrics(scale);
+    res->pixelGeneration = -1;
+    res->textureGeneration = -1;
+
+    return res;
+}
+
+void releaseScale(scaleResources *res) {
+    SDL_DestroySurface(res->maskPixels);
+    SDL_DestroySurface(res->shadowPixels);
+    SDL_DestroySurface(res->iconPixels);
+    forgetTextureState(res->mask);
+    forgetTextureState(res->shadow);
+    forgetTextureState(res->icons);
+    if (res->mask)
+        SDL_DestroyTexture(res->mask);
+    if (res->shadow)
+        SDL_DestroyTexture(res->shadow);
+    if (res->icons)
+        SDL_DestroyTexture(res->icons);
+    SDL_zerop(res);
+}
+
+void storeScalePixels(scaleResources *res, scaleResources *built, int generation) {
+    SDL_DestroySurface(res->maskPixels);
+    SDL_DestroySurface(res->shadowPixels);
+    res->maskPixels = built->maskPixels;
+    res->shadowPixels = built->shadowPixels;
+    if (built->iconPixels) {
+        SDL_DestroySurface(res->iconPixels);
+        res->iconPixels = built->iconPixels;
+    }
+    res->atlas = built->atlas;
+    res->pixelGeneration = generation;
+}
+
+void activateScale(const scaleResources *res) {
+    layout.metrics = res->metrics;
+
+    // The inner tile rounds the title bar and client area, which are inset by the border
+    int outer = res->metrics.radius, inner = outer - res->metrics.border;
+    corners.mask = res->mask;
+    corners.outer = (SDL_FRect){0, 0, outer, outer};
+    corners.inner = (SDL_FRect){outer, 0, inner, inner};
+    captionButtons.icons = res->icons;
+
+    if (shadow.analytic) {
+        shadow.texture = res->shadow;
+        shadow.atlas = res->atlas;
+        shadow.margin = res->atlas.margin;
+    } else {
+        shadow.corner = res->shadow;
+    }
+
+    // Set shadow color and intensity
+    applyShadowTint();
+}
+
+bool buildScalePixels(scaleResources *res, const shadowGeometry *geometry) {
+    int outer = res->metrics.radius, inner = outer - res->metrics.border;
+    res->maskPixels = createCornerMask(outer, inner);
+    // Icons are only drawn once per scale, later builds for new shadows skip them
+    res->iconPixels = res->icons ? NULL : createCaptionIcons(res->metrics.buttonSize,
+                                                             res->metrics.border);
+
+    // Let the shadow follow the rounded corners
+    if (shadow.analytic) {
+        // Evaluate the shadow in device pixels, so it's exact at fractional scales too
+        float scale = res->scale;
+        shadowGeometry scaled = {
+            geometry->radius * scale, geometry->spread * scale,
+            geometry->offsetX * scale, geometry->offsetY * scale
+        };
+        res->shadowPixels = createShadowAtlas(&scaled, outer, &res->atlas);
+    } else {
+        res->shadowPixels = createShadowCorner(outer);
+    }
+
+    if (!res->maskPixels || !res->shadowPixels) {
+        SDL_DestroySurface(res->maskPixels);
+        SDL_DestroySurface(res->shadowPixels);
+        SDL_DestroySurface(res->iconPixels);
+        res->maskPixels = NULL;
+        res->shadowPixels = NULL;
+        res->iconPixels = NULL;
+        return false;
+    }
+    return true;
+}
+
+SDL_Surface *createCornerMask(int outer, int inner) {
+    SDL_Surface *mask = SDL_CreateSurface(outer + inner, outer, SDL_PIXELFORMAT_RGBA32);
+    if (!mask)
+        return NULL;
+    SDL_memset(mask->pixels, 0, mask->h * mask->pitch);
+
+    /* White pixels whose alpha is the coverage of a quarter circle, computed from its signed
+     * distance function at each pixel center. Both tiles are stored for the top left corner and
+     * get flipped for the others. */
+    for (int tile = 0; tile < 2; tile++) {
+        int r = tile ? inner : outer, ox = tile ? outer : 0;
+        for (int y = 0; y < r; y++) {
+            for (int x = 0; x < r; x++) {
+                float dx = r - (x + 0.5f), dy = r - (y + 0.5f);
+                float sdf = sqrtf(dx * dx + dy * dy) - r;
+                Uint8 *p = (Uint8 *)mask->pixels + y * mask->pitch + 4 * (ox + x);
+                p[0] = p[1] = p[2] = 255;
+                p[3] = SDL_clamp(0.5f - sdf, 0.0f, 1.0f) * 255 + 0.5f;
+            }
+        }
+    }
+
+    return mask;
+}
+
+SDL_Surface *createShadowCorner(int radius) {
+    SDL_Surface *src = shadow.cornerSource;
+    SDL_Surface *dst = SDL_CreateSurface(src->w, src->h, SDL_PIXELFORMAT_RGBA32);
+    if (!dst)
+        return NULL;
+
+    // The square window corner lies inside the tile, where the shadow margin begins
+    float cx = src->w - shadow.margin - radius;
+    float cy = src->h - shadow.margin - radius;
+    float bend = 2 * (1 - sqrtf(0.5f)) * radius;
+
+    for (int y = 0; y < dst->h; y++) {
+        for (int x = 0; x < dst->w; x++) {
+            float sx = x, sy = y;
+            float wx = x + 0.5f - cx, wy = y + 0.5f - cy;
+
+            /* Around the arc, sample the square shadow closer to its corner. The shift is zero
+             * where the arc meets the straight edges and reaches the full distance between arc and
+             * square corner on the diagonal, so the rounded shadow joins the edge tiles
+             * seamlessly. */
+            if (wx > 0 && wy > 0) {
+                float shift = bend * wx * wy / (wx * wx + wy * wy);
+                sx += shift;
+                sy += shift;
+            }
+
+            // Bilinear sample, clamped to the tile
+            sx = SDL_clamp(sx, 0.0f, src->w - 1.0f);
+            sy = SDL_clamp(sy, 0.0f, src->h - 1.0f);
+            int x0 = sx, y0 = sy;
+            int x1 = SDL_min(x0 + 1, src->w - 1), y1 = SDL_min(y0 + 1, src->h - 1);
+            float fx = sx - x0, fy = sy - y0;
+            const Uint8 *row0 = (const Uint8 *)src->pixels + y0 * src->pitch;
+            const Uint8 *row1 = (const Uint8 *)src->pixels + y1 * src->pitch;
+            Uint8 *out = (Uint8 *)dst->pixels + y * dst->pitch + 4 * x;
+            for (int i = 0; i < 4; i++) {
+                float top = row0[4 * x0 + i] + (row0[4 * x1 + i] - row0[4 * x0 + i]) * fx;
+                float bottom = row1[4 * x0 + i] + (row1[4 * x1 + i] - row1[4 * x0 + i]) * fx;
+                out[i] = top + (bottom - top) * fy + 0.5f;
+            }
+        }
+    }
+
+    return dst;
+}
+
+SDL_Surface *loadShadowImage(unsigned char *png, unsigned int len) {
+    SDL_Surface *image = IMG_LoadTyped_IO(SDL_IOFromMem(png, len), true, "png");
+    SDL_Surface *surface = SDL_ConvertSurface(image, SDL_PIXELFORMAT_RGBA32);
+    SDL_DestroySurface(image);
+    if (!surface)
+        return NULL;
+
+    // Make the shadow white, so its color can be set with color modulation
+    for (int y = 0; y < surface->h; y++) {
+        Uint8 *p = (Uint8 *)surface->pixels + y * surface->pitch;
+        for (int x = 0; x < surface->w; x++, p += 4)
+            p[0] = p[1] = p[2] = 255;
+    }
+
+    return surface;
+}
+
+bool timeImageShadow(const float *scales, int count, Uint64 *decode, Uint64 *corners) {
+    // Decode the images once, then round their corner for every scale
+    Uint64 start = SDL_GetTicksNS();
+    SDL_Surface *corner = loadShadowImage(corner_png, corner_png_len);
+    SDL_Surface *bottom = loadShadowImage(bottom_png, bottom_png_len);
+    SDL_Surface *left = loadShadowImage(left_png, left_png_len);
+    *decode = SDL_GetTicksNS() - start;
+    bool loaded = corner && bottom && left;
+    if (loaded) {
+        shadow.cornerSource = corner;
+        shadow.margin = left->w;
+        start = SDL_GetTicksNS();
+        for (int i = 0; i < count; i++)
+            SDL_DestroySurface(createShadowCorner(getLayoutMetrics(scales[i]).radius));
+        *corners = SDL_GetTicksNS() - start;
+        shadow.cornerSource = NULL;
+    }
+    SDL_DestroySurface(corner);
+    SDL_DestroySurface(bottom);
+    SDL_DestroySurface(left);
+    return loaded;
+}
+
+void setShadowRadius(float radius) {
+    if (radius == shadow.geometry.radius)
+        return;
+    shadow.geometry.radius = SDL_max(radius, 0.0f);
+    invalidateShadowGeometry();
+}
+
+void setShadowSpread(float spread) {
+    if (spread == shadow.geometry.spread)
+        return;
+    shadow.geometry.spread = spread;
+    invalidateShadowGeometry();
+}
+
+void setShadowOffset(float x, float y) {
+    if (x == shadow.geometry.offsetX && y == shadow.geometry.offsetY)
+        return;
+    shadow.geometry.offsetX = x;
+    shadow.geometry.offsetY = y;
+    invalidateShadowGeometry();
+}
+
+void setShadowOpacity(float opacity) {
+    shadow.opacity = SDL_clamp(opacity, 0.0f, 1.0f);
+    // Opacity is pure modulation state, so nothing has to be regenerated
+    applyShadowTint();
+    windowShouldBeRedrawn = true;
+}
+
+void setShadowColor(SDL_Color color) {
+    shadow.color = color;
+    applyShadowTint();
+    windowShouldBeRedrawn = true;
+}
+
+void invalidateShadowGeometry(void) {
+    // The image-based shadow has a fixed geometry, so only the analytic one can follow it
+    if (!shadow.analytic) {
+        SDL_Log("Shadow geometry needs the analytic shadow, using it instead of the images");
+        shadow.analytic = true;
+    }
+    // Nothing exists before the renderer
+    if (!scales.mutex)
+        return;
+
+    // Only the atlases depend on the geometry
+    SDL_LockMutex(scales.mutex);
+    scales.geometry = shadow.geometry;
+    scales.generation++;
+    SDL_UnlockMutex(scales.mutex);
+
+    // Rebuild the current one right away and the others in the background
+    int margin = shadow.margin;
+    activateScale(getScaleResources(layout.scale));
+    startScaleWorker();
+
+    // The chrome only moves if the margin changed
+    if (shadow.margin != margin)
+        updateLayout();
+    else
+        windowShouldBeRedrawn = true;
+}
+
+void applyShadowTint(void) {
+    /* The opacity refers to the darkest part of the shadow, which is about half opaque in the
+     * images and fully opaque in the analytic atlas */
+    float imageAlpha = SDL_min(shadow.opacity * 255 / SHADOW_IMAGE_PEAK_ALPHA, 1.0f);
+    Uint8 r = shadow.color.r, g = shadow.color.g, b = shadow.color.b;
+
+    SDL_Texture *images[] = {shadow.corner, shadow.bottom, shadow.left};
+    for (size_t i = 0; i < SDL_arraysize(images); i++) {
+        if (!images[i])
+            continue;
+        setTextureTint(images[i], r, g, b, imageAlpha);
+    }
+
+    if (shadow.texture) {
+        setTextureTint(shadow.texture, r, g, b, shadow.opacity);
+    }
+}
+
+void updateThemePalette(void) {
+    // Repeated notifications with the same settings are answered from the cache
+    const palette *base = theme.settings.dark ? &theme.dark : &theme.light;
+    derivePalette(base, &theme.settings, &theme.active);
+}
+
+void fadeToTheme(void) {
+    // Fade from what's on screen, which may be in the middle of another fade
+    if (startupFinished)
+        startPaletteFade(&theme.shown, &theme.active, options.themeFade, getRefreshRate());
 }
@@ -0,0 +1,125 @@
+/* 
+  A fully functional SDL3 window with a custom-drawn non-client area and shadow 
+  Copyright (C) 2025 fischflocke
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Standard includes
+#include <stdbool.h>
+
+// SDL3 includes
+#include <SDL3/SDL.h>
+
+// Local includes
+#include "pacing.h"
+#include "trace.h"
+
+// Refresh rate assumed if the display doesn't report one
+#define DEFAULT_REFRESH_RATE 60
+// Time reserved before a vblank for timer inaccuracy and the compositor
+#define FRAME_SAFETY_NS (2 * SDL_NS_PER_MS)
+
+static Uint64 getNextVblank(Uint64 time);
+
+/* Frames are started as late as possible before the vblank they are meant for, so they show the
+ * latest input. The vblanks are predicted from the display's refresh rate and the end of the last
+ * present, which is right after a vblank with vsync. Without vsync, that still limits the frame
+ * rate to the refresh rate. */
+static struct {
+    int vsync;
+    Uint64 period;
+    // End of the last present, 0 before the first one
+    Uint64 vblank;
+    // Estimated time from starting a frame to submitting it, which rises fast and falls slowly
+    Uint64 cost;
+    Uint64 start;
+    Uint64 submitted;
+    Uint64 deadline;
+    Uint64 missed;
+} pacing = {
+    .period = SDL_NS_PER_SECOND / DEFAULT_REFRESH_RATE
+};
+
+void initFramePacing(SDL_Renderer *renderer, SDL_Window *window, int vsync) {
+    // Not every driver supports adaptive vsync, fall back to regular vsync then
+    if (!SDL_SetRenderVSync(renderer, vsync) && vsync == SDL_RENDERER_VSYNC_ADAPTIVE) {
+        SDL_Log("Adaptive vsync is not supported, using vsync");
+        vsync = 1;
+        SDL_SetRenderVSync(renderer, vsync);
+    }
+    pacing.vsync = vsync;
+    updateRefreshRate(window);
+}
+
+void updateRefreshRate(SDL_Window *window) {
+    const SDL_DisplayMode *mode = SDL_GetCurrentDisplayMode(SDL_GetDisplayForWindow(window));
+    if (mode && mode->refresh_rate_numerator > 0 && mode->refresh_rate_denominator > 0) {
+        pacing.period = SDL_NS_PER_SECOND * mode->refresh_rate_denominator /
+                        mode->refresh_rate_numerator;
+    } else if (mode && mode->refresh_rate > 0) {
+        pacing.period = SDL_NS_PER_SECOND / mode->refresh_rate;
+    } else {
+        pacing.period = SDL_NS_PER_SECOND / DEFAULT_REFRESH_RATE;
+    }
+}
+
+Uint64 getFrameDelay(void) {
+    // Draw right away until the vblanks can be predicted
+    if (!pacing.vblank)
+        return 0;
+
+    // Start the frame for the first vblank it can still make
+    Uint64 now = traceNow();
+    Uint64 lead = pacing.cost + FRAME_SAFETY_NS;
+    Uint64 begin = getNextVblank(now + lead) - lead;
+    return begin > now ? begin - now : 0;
+}
+
+void beginFrame(void) {
+    pacing.start = traceNow();
+    pacing.deadline = pacing.vblank ? getNextVblank(pacing.start + pacing.cost) : 0;
+}
+
+void markFrameSubmitted(void) {
+    pacing.submitted = traceNow();
+}
+
+void finishFrame(void) {
+    Uint64 end = traceNow();
+    Uint64 cost = pacing.submitted - pacing.start;
+    pacing.cost = cost > pacing.cost ? cost : (pacing.cost * 7 + cost) / 8;
+
+    // A frame that showed up a vblank later than planned missed its deadline
+    if (pacing.deadline && end > pacing.deadline + pacing.period / 2) {
+        pacing.missed++;
+        traceSpan("missed frame", pacing.deadline, end);
+    }
+    pacing.vblank = end;
+}
+
+float getRefreshRate(void) {
+    return (float)SDL_NS_PER_SECOND / pacing.period;
+}
+
+Uint64 getMissedFrames(void) {
+    return pacing.missed;
+}
+
+static Uint64 getNextVblank(Uint64 time) {
+    if (time <= pacing.vblank)
+        return pacing.vblank + pacing.period;
+    Uint64 periods = (time - pacing.vblank + pacing.period - 1) / pacing.period;
+    return pacing.vblank + periods * pacing.period;
+}
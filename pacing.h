@@ -0,0 +1,37 @@
+/* 
+  A fully functional SDL3 window with a custom-drawn non-client area and shadow 
+  Copyright (C) 2025 fischflocke
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef PACING_H
+#define PACING_H
+
+// Standard includes
+#include <stdbool.h>
+
+// SDL3 includes
+#include <SDL3/SDL.h>
+
+void initFramePacing(SDL_Renderer *renderer, SDL_Window *window, int vsync);
+void updateRefreshRate(SDL_Window *window);
+Uint64 getFrameDelay(void);
+void beginFrame(void);
+void markFrameSubmitted(void);
+void finishFrame(void);
+float getRefreshRate(void);
+Uint64 getMissedFrames(void);
+
+#endif
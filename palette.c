@@ -0,0 +1,158 @@
+/* 
+  A fully functional SDL3 window with a custom-drawn non-client area and shadow 
+  Copyright (C) 2025 fischflocke
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Standard includes
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// SDL3 includes
+#include <SDL3/SDL.h>
+
+// Local includes
+#include "palette.h"
+
+static SDL_Color *findPaletteColor(const char *key, size_t len, palette *light, palette *dark);
+static bool parseColor(const char *value, size_t len, SDL_Color *color);
+static float toLinear(Uint8 value);
+static Uint8 fromLinear(float value);
+
+// Names of the colors in palette files, prefixed by "light." or "dark."
+static const struct {
+    const char *name;
+    size_t offset;
+} paletteColors[] = {
+    {"border", offsetof(palette, border)},
+    {"background", offsetof(palette, background)},
+    {"title-bar", offsetof(palette, titleBar)},
+    {"text", offsetof(palette, text)}
+};
+
+/* Palette files have one color per line, as a name and RRGGBB or RRGGBBAA, for example
+ * "dark.title-bar 202020". Empty lines and lines starting with # are ignored, and colors that are
+ * missing keep their value. The data doesn't have to be null-terminated, so it can be parsed
+ * straight from a mapped file. Nothing is changed unless the whole file is valid. */
+bool parsePalettes(const char *data, size_t size, palette *light, palette *dark) {
+    palette newLight = *light, newDark = *dark;
+    const char *end = data + size;
+
+    for (int line = 1; data < end; line++) {
+        // Split off the line and trim it
+        const char *lineEnd = data;
+        while (lineEnd < end && *lineEnd != '\n')
+            lineEnd++;
+        const char *next = lineEnd < end ? lineEnd + 1 : end;
+        while (data < lineEnd && SDL_isspace(*data))
+            data++;
+        while (lineEnd > data && SDL_isspace(lineEnd[-1]))
+            lineEnd--;
+
+        if (data < lineEnd && *data != '#') {
+            // Name and value are separated by whitespace
+            const char *key = data, *value = data;
+            while (value < lineEnd && !SDL_isspace(*value))
+                value++;
+            size_t keyLen = value - key;
+            while (value < lineEnd && SDL_isspace(*value))
+                value++;
+
+            SDL_Color *color = findPaletteColor(key, keyLen, &newLight, &newDark);
+            if (!color || !parseColor(value, lineEnd - value, color)) {
+                SDL_SetError("Invalid palette color in line %d", line);
+                return false;
+            }
+        }
+
+        data = next;
+    }
+
+    *light = newLight;
+    *dark = newDark;
+    return true;
+}
+
+static SDL_Color *findPaletteColor(const char *key, size_t len, palette *light, palette *dark) {
+    palette *p;
+    if (len > 6 && SDL_strncmp(key, "light.", 6) == 0) {
+        p = light;
+        key += 6;
+        len -= 6;
+    } else if (len > 5 && SDL_strncmp(key, "dark.", 5) == 0) {
+        p = dark;
+        key += 5;
+        len -= 5;
+    } else {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < SDL_arraysize(paletteColors); i++) {
+        if (SDL_strlen(paletteColors[i].name) == len &&
+            SDL_strncmp(paletteColors[i].name, key, len) == 0)
+            return (SDL_Color *)((char *)p + paletteColors[i].offset);
+    }
+    return NULL;
+}
+
+static bool parseColor(const char *value, size_t len, SDL_Color *color) {
+    if (len != 6 && len != 8)
+        return false;
+
+    Uint8 channels[4] = {0, 0, 0, 255};
+    for (size_t i = 0; i < len; i++) {
+        char c = SDL_tolower(value[i]);
+        int digit;
+        if (c >= '0' && c <= '9')
+            digit = c - '0';
+        else if (c >= 'a' && c <= 'f')
+            digit = c - 'a' + 10;
+        else
+            return false;
+        channels[i / 2] = channels[i / 2] * (i % 2 ? 16 : 0) + digit;
+    }
+
+    *color = (SDL_Color){channels[0], channels[1], channels[2], channels[3]};
+    return true;
+}
+
+SDL_Color mixColors(SDL_Color from, SDL_Color to, float t) {
+    // Mix in linear light, so the middle between light and dark doesn't look too dark
+    SDL_Color color;
+    color.r = fromLinear(toLinear(from.r) + (toLinear(to.r) - toLinear(from.r)) * t);
+    color.g = fromLinear(toLinear(from.g) + (toLinear(to.g) - toLinear(from.g)) * t);
+    color.b = fromLinear(toLinear(from.b) + (toLinear(to.b) - toLinear(from.b)) * t);
+    // Alpha is linear already
+    color.a = from.a + (to.a - from.a) * t + 0.5f;
+    return color;
+}
+
+float getContrastRatio(SDL_Color a, SDL_Color b) {
+    // Contrast of the relative luminances as defined by WCAG
+    float la = 0.2126f * toLinear(a.r) + 0.7152f * toLinear(a.g) + 0.0722f * toLinear(a.b);
+    float lb = 0.2126f * toLinear(b.r) + 0.7152f * toLinear(b.g) + 0.0722f * toLinear(b.b);
+    return (SDL_max(la, lb) + 0.05f) / (SDL_min(la, lb) + 0.05f);
+}
+
+static float toLinear(Uint8 value) {
+    float v = value / 255.0f;
+    return v <= 0.04045f ? v / 12.92f : powf((v + 0.055f) / 1.055f, 2.4f);
+}
+
+static Uint8 fromLinear(float value) {
+    float v = value <= 0.0031308f ? value * 12.92f : 1.055f * powf(value, 1 / 2.4f) - 0.055f;
+    return SDL_clamp(v, 0.0f, 1.0f) * 255 + 0.5f;
+}
@@ -0,0 +1,41 @@
+/* 
+  A fully functional SDL3 window with a custom-drawn non-client area and shadow 
+  Copyright (C) 2025 fischflocke
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef PALETTE_H
+#define PALETTE_H
+
+// Standard includes
+#include <stdbool.h>
+#include <stddef.h>
+
+// SDL3 includes
+#include <SDL3/SDL.h>
+
+// Colors of the chrome
+typedef struct {
+    SDL_Color border;
+    SDL_Color background;
+    SDL_Color titleBar;
+    SDL_Color text;
+} palette;
+
+bool parsePalettes(const char *data, size_t size, palette *light, palette *dark);
+SDL_Color mixColors(SDL_Color from, SDL_Color to, float t);
+float getContrastRatio(SDL_Color a, SDL_Color b);
+
+#endif
@@ -0,0 +1,299 @@
+/* 
+  A fully functional SDL3 window with a custom-drawn non-client area and shadow 
+  Copyright (C) 2025 fischflocke
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Standard includes
+#include <stdbool.h>
+
+// SDL3 includes
+#include <SDL3/SDL.h>
+
+// Local includes
+#include "layout.h"
+#include "region.h"
+
+// Xlib and XShape constants, so neither their headers nor their libraries are needed to build
+#define X_SHAPE_INPUT 2
+#define X_SHAPE_SET 0
+#define X_UNSORTED 0
+#define X_CARDINAL 6
+#define X_PROP_MODE_REPLACE 0
+
+typedef struct {
+    short x, y;
+    unsigned short width, height;
+} xRectangle;
+
+static bool loadX11(SDL_Window *window);
+static bool regionsEqual(const windowRegion *a, const windowRegion *b);
+static bool regionContains(const windowRegion *region, const SDL_Point *point);
+static bool checkX11Regions(const windowRegion *opaque, const windowRegion *input);
+
+/* Only the shadow margin and the rounded corners are transparent, but the compositor can't know
+ * that and blends the whole window. On X11 the margin would also take clicks meant for the windows
+ * behind it. So the opaque region is announced through _NET_WM_OPAQUE_REGION and the input region
+ * is set with XShape. libX11 and libXext are loaded at runtime, SDL has them loaded on X11 anyway.
+ * Other backends don't expose a way to set the regions, so there this does nothing. */
+static struct {
+    bool loaded;
+    bool available;
+    SDL_SharedObject *libX11;
+    SDL_SharedObject *libXext;
+    void *display;
+    unsigned long window;
+    unsigned long opaqueAtom;
+    // Xlib and XShape functions
+    unsigned long (*internAtom)(void *display, const char *name, int onlyIfExists);
+    int (*changeProperty)(void *display, unsigned long window, unsigned long property,
+                          unsigned long type, int format, int mode, const unsigned char *data,
+                          int count);
+    int (*getWindowProperty)(void *display, unsigned long window, unsigned long property,
+                             long offset, long length, int remove, unsigned long type,
+                             unsigned long *actualType, int *actualFormat, unsigned long *count,
+                             unsigned long *bytesAfter, unsigned char **data);
+    int (*flush)(void *display);
+    int (*sync)(void *display, int discard);
+    int (*free)(void *data);
+    void (*shapeCombineRectangles)(void *display, unsigned long window, int kind, int x, int y,
+                                   xRectangle *rects, int count, int op, int ordering);
+    xRectangle *(*shapeGetRectangles)(void *display, unsigned long window, int kind, int *count,
+                                      int *ordering);
+    // Regions last applied, nothing is sent again while they stay the same
+    windowRegion opaque;
+    windowRegion input;
+} x11;
+
+void getOpaqueRegion(const windowLayout *layout, windowRegion *region) {
+    const SDL_Rect *bg = &layout->background;
+    if (layout->edgeToEdge) {
+        region->rects[0] = layout->window;
+        region->count = 1;
+        return;
+    }
+
+    // The background without its rounded corners, split like drawRoundedRect() fills it
+    int r = layout->metrics.radius;
+    region->rects[0] = (SDL_Rect){bg->x + r, bg->y, bg->w - 2 * r, bg->h};
+    region->rects[1] = (SDL_Rect){bg->x, bg->y + r, r, bg->h - 2 * r};
+    region->rects[2] = (SDL_Rect){bg->x + bg->w - r, bg->y + r, r, bg->h - 2 * r};
+    region->count = 3;
+}
+
+void getInputRegion(const windowLayout *layout, windowRegion *region) {
+    // The background and the resize borders around it, which reach into the margin
+    int tol = layout->edgeToEdge ? 0 : layout->metrics.edgeTol;
+    SDL_Rect area = {layout->background.x - tol, layout->background.y - tol,
+                     layout->background.w + 2 * tol + 1, layout->background.h + 2 * tol + 1};
+    SDL_GetRectIntersection(&area, &layout->window, &region->rects[0]);
+    region->count = 1;
+}
+
+void applyWindowRegions(SDL_Window *window, const windowLayout *layout) {
+    windowRegion opaque, input;
+    getOpaqueRegion(layout, &opaque);
+    getInputRegion(layout, &input);
+    if (regionsEqual(&opaque, &x11.opaque) && regionsEqual(&input, &x11.input))
+        return;
+    x11.opaque = opaque;
+    x11.input = input;
+    if (!loadX11(window))
+        return;
+
+    // Opaque region as x, y, width and height of each rect
+    long cardinals[SDL_arraysize(opaque.rects) * 4];
+    for (int i = 0; i < opaque.count; i++) {
+        const SDL_Rect *rect = &opaque.rects[i];
+        cardinals[i * 4] = rect->x;
+        cardinals[i * 4 + 1] = rect->y;
+        cardinals[i * 4 + 2] = rect->w;
+        cardinals[i * 4 + 3] = rect->h;
+    }
+    x11.changeProperty(x11.display, x11.window, x11.opaqueAtom, X_CARDINAL, 32,
+                       X_PROP_MODE_REPLACE, (const unsigned char *)cardinals,
+                       opaque.count * 4);
+
+    // Input region, clicks outside of it go to the windows behind
+    xRectangle rects[SDL_arraysize(input.rects)];
+    for (int i = 0; i < input.count; i++) {
+        const SDL_Rect *rect = &input.rects[i];
+        rects[i] = (xRectangle){rect->x, rect->y, rect->w, rect->h};
+    }
+    x11.shapeCombineRectangles(x11.display, x11.window, X_SHAPE_INPUT, 0, 0, rects,
+                               input.count, X_SHAPE_SET, X_UNSORTED);
+    x11.flush(x11.display);
+}
+
+bool checkWindowRegions(SDL_Window *window, const windowLayout *layout,
+                        SDL_HitTestResult (*hitTest)(const SDL_Point *area)) {
+    windowRegion opaque, input;
+    getOpaqueRegion(layout, &opaque);
+    getInputRegion(layout, &input);
+    int failures = 0;
+
+    // The opaque region lies within the background and skips the rounded corners
+    int r = layout->edgeToEdge ? 0 : layout->metrics.radius;
+    const SDL_Rect *bg = &layout->background;
+    SDL_Rect corners[4] = {
+        {bg->x, bg->y, r, r}, {bg->x + bg->w - r, bg->y, r, r},
+        {bg->x, bg->y + bg->h - r, r, r}, {bg->x + bg->w - r, bg->y + bg->h - r, r, r}
+    };
+    for (int i = 0; i < opaque.count; i++) {
+        SDL_Rect inside;
+        if (!SDL_GetRectIntersection(&opaque.rects[i], bg, &inside) ||
+            !SDL_RectsEqual(&inside, &opaque.rects[i])) {
+            SDL_Log("Opaque rect %d leaves the background", i);
+            failures++;
+        }
+        for (int j = 0; j < 4; j++) {
+            if (SDL_HasRectIntersection(&opaque.rects[i], &corners[j])) {
+                SDL_Log("Opaque rect %d covers a rounded corner", i);
+                failures++;
+            }
+        }
+    }
+
+    // Every point the hit test does something with takes input
+    int w = layout->window.w / layout->scale, h = layout->window.h / layout->scale;
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            SDL_Point area = {x, y}, pos = {x * layout->scale, y * layout->scale};
+            bool used = hitTest(&area) != SDL_HITTEST_NORMAL || SDL_PointInRect(&pos, bg);
+            if (used && !regionContains(&input, &pos)) {
+                SDL_Log("Point %d, %d is outside of the input region", x, y);
+                failures++;
+            }
+        }
+    }
+
+    // The window system has what was applied
+    if (loadX11(window)) {
+        applyWindowRegions(window, layout);
+        if (!checkX11Regions(&opaque, &input))
+            failures++;
+    } else {
+        SDL_Log("Regions are only applied on X11, the %s driver was not checked",
+                SDL_GetCurrentVideoDriver());
+    }
+
+    SDL_Log("Region check: %d failures", failures);
+    return failures == 0;
+}
+
+static bool loadX11(SDL_Window *window) {
+    if (x11.loaded)
+        return x11.available;
+    x11.loaded = true;
+
+    const char *driver = SDL_GetCurrentVideoDriver();
+    if (!driver || SDL_strcmp(driver, "x11") != 0)
+        return false;
+    SDL_PropertiesID props = SDL_GetWindowProperties(window);
+    x11.display = SDL_GetPointerProperty(props, SDL_PROP_WINDOW_X11_DISPLAY_POINTER, NULL);
+    x11.window = SDL_GetNumberProperty(props, SDL_PROP_WINDOW_X11_WINDOW_NUMBER, 0);
+    x11.libX11 = SDL_LoadObject("libX11.so.6");
+    x11.libXext = SDL_LoadObject("libXext.so.6");
+    if (!x11.display || !x11.window || !x11.libX11 || !x11.libXext)
+        return false;
+
+    x11.internAtom = (void *)SDL_LoadFunction(x11.libX11, "XInternAtom");
+    x11.changeProperty = (void *)SDL_LoadFunction(x11.libX11, "XChangeProperty");
+    x11.getWindowProperty = (void *)SDL_LoadFunction(x11.libX11, "XGetWindowProperty");
+    x11.flush = (void *)SDL_LoadFunction(x11.libX11, "XFlush");
+    x11.sync = (void *)SDL_LoadFunction(x11.libX11, "XSync");
+    x11.free = (void *)SDL_LoadFunction(x11.libX11, "XFree");
+    x11.shapeCombineRectangles = (void *)SDL_LoadFunction(x11.libXext,
+                                                          "XShapeCombineRectangles");
+    x11.shapeGetRectangles = (void *)SDL_LoadFunction(x11.libXext, "XShapeGetRectangles");
+    if (!x11.internAtom || !x11.changeProperty || !x11.getWindowProperty ||
+        !x11.flush || !x11.sync || !x11.free || !x11.shapeCombineRectangles ||
+        !x11.shapeGetRectangles)
+        return false;
+
+    x11.opaqueAtom = x11.internAtom(x11.display, "_NET_WM_OPAQUE_REGION", 0);
+    x11.available = x11.opaqueAtom != 0;
+    return x11.available;
+}
+
+static bool regionsEqual(const windowRegion *a, const windowRegion *b) {
+    if (a->count != b->count)
+        return false;
+    for (int i = 0; i < a->count; i++) {
+        if (!SDL_RectsEqual(&a->rects[i], &b->rects[i]))
+            return false;
+    }
+    return true;
+}
+
+static bool regionContains(const windowRegion *region, const SDL_Point *point) {
+    for (int i = 0; i < region->count; i++) {
+        if (SDL_PointInRect(point, &region->rects[i]))
+            return true;
+    }
+    return false;
+}
+
+static bool checkX11Regions(const windowRegion *opaque, const windowRegion *input) {
+    bool passed = true;
+    x11.sync(x11.display, 0);
+
+    // Read back the opaque region's property
+    unsigned long type, count, after;
+    int format;
+    unsigned char *data = NULL;
+    x11.getWindowProperty(x11.display, x11.window, x11.opaqueAtom, 0, 64, 0,
+                          X_CARDINAL, &type, &format, &count, &after, &data);
+    const long *cardinals = (const long *)data;
+    if (!data || count != (unsigned long)opaque->count * 4) {
+        SDL_Log("The opaque region has %lu values instead of %d", data ? count : 0,
+                opaque->count * 4);
+        passed = false;
+    } else {
+        for (int i = 0; i < opaque->count; i++) {
+            const SDL_Rect *rect = &opaque->rects[i];
+            if (cardinals[i * 4] != rect->x || cardinals[i * 4 + 1] != rect->y ||
+                cardinals[i * 4 + 2] != rect->w || cardinals[i * 4 + 3] != rect->h) {
+                SDL_Log("Opaque rect %d differs on the X server", i);
+                passed = false;
+            }
+        }
+    }
+    if (data)
+        x11.free(data);
+
+    // And the input shape's rects
+    int rectCount, ordering;
+    xRectangle *rects = x11.shapeGetRectangles(x11.display, x11.window, X_SHAPE_INPUT,
+                                               &rectCount, &ordering);
+    if (!rects || rectCount != input->count) {
+        SDL_Log("The input shape has %d rects instead of %d", rects ? rectCount : 0,
+                input->count);
+        passed = false;
+    } else {
+        for (int i = 0; i < input->count; i++) {
+            const SDL_Rect *rect = &input->rects[i];
+            if (rects[i].x != rect->x || rects[i].y != rect->y || rects[i].width != rect->w ||
+                rects[i].height != rect->h) {
+                SDL_Log("Input rect %d differs on the X server", i);
+                passed = false;
+            }
+        }
+    }
+    if (rects)
+        x11.free(rects);
+
+    return passed;
+}
@@ -0,0 +1,43 @@
+/* 
+  A fully functional SDL3 window with a custom-drawn non-client area and shadow 
+  Copyright (C) 2025 fischflocke
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef REGION_H
+#define REGION_H
+
+// Standard includes
+#include <stdbool.h>
+
+// SDL3 includes
+#include <SDL3/SDL.h>
+
+// Local includes
+#include "layout.h"
+
+// Part of the window as non-overlapping rects in device pixels
+typedef struct {
+    SDL_Rect rects[3];
+    int count;
+} windowRegion;
+
+void getOpaqueRegion(const windowLayout *layout, windowRegion *region);
+void getInputRegion(const windowLayout *layout, windowRegion *region);
+void applyWindowRegions(SDL_Window *window, const windowLayout *layout);
+bool checkWindowRegions(SDL_Window *window, const windowLayout *layout,
+                        SDL_HitTestResult (*hitTest)(const SDL_Point *area));
+
+#endif
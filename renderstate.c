@@ -0,0 +1,150 @@
+/* 
+  A fully functional SDL3 window with a custom-drawn non-client area and shadow 
+  Copyright (C) 2025 fischflocke
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Standard includes
+#include <stdbool.h>
+
+// SDL3 includes
+#include <SDL3/SDL.h>
+
+// Local includes
+#include "renderstate.h"
+
+// Number of textures whose tint is remembered, the chrome only tints a few
+#define TEXTURE_STATES 16
+
+typedef struct {
+    SDL_Texture *texture;
+    Uint8 r, g, b;
+    float alpha;
+} textureState;
+
+static textureState *findTextureState(SDL_Texture *texture);
+static bool skip(bool unchanged);
+
+/* The last state set through these functions, so setting the same state again costs nothing.
+ * Anything that changes the renderer's state behind their back has to reset it. */
+static struct {
+    SDL_Renderer *renderer;
+    // Values that don't match anything the renderer could have mark unknown state
+    bool colorKnown;
+    SDL_Color color;
+    SDL_BlendMode blendMode;
+    bool clipped;
+    SDL_Rect clip;
+    bool targetKnown;
+    SDL_Texture *target;
+    textureState textures[TEXTURE_STATES];
+    int nextTexture;
+    Uint64 changes;
+    Uint64 skips;
+} state;
+
+void resetRenderState(SDL_Renderer *renderer) {
+    state.renderer = renderer;
+    state.colorKnown = false;
+    state.blendMode = SDL_BLENDMODE_INVALID;
+    state.clipped = true;
+    state.clip = (SDL_Rect){0, 0, -1, -1};
+    state.targetKnown = false;
+    SDL_memset(state.textures, 0, sizeof(state.textures));
+}
+
+void setDrawColor(SDL_Color color) {
+    if (skip(state.colorKnown && SDL_memcmp(&color, &state.color, sizeof(color)) == 0))
+        return;
+    SDL_SetRenderDrawColor(state.renderer, color.r, color.g, color.b, color.a);
+    state.colorKnown = true;
+    state.color = color;
+}
+
+void setDrawBlendMode(SDL_BlendMode mode) {
+    if (skip(mode == state.blendMode))
+        return;
+    SDL_SetRenderDrawBlendMode(state.renderer, mode);
+    state.blendMode = mode;
+}
+
+void setClipRect(const SDL_Rect *rect) {
+    bool unchanged = rect ? state.clipped && SDL_RectsEqual(rect, &state.clip) : !state.clipped;
+    if (skip(unchanged))
+        return;
+    SDL_SetRenderClipRect(state.renderer, rect);
+    state.clipped = rect != NULL;
+    if (rect)
+        state.clip = *rect;
+}
+
+void setRenderTarget(SDL_Texture *target) {
+    if (skip(state.targetKnown && target == state.target))
+        return;
+    SDL_SetRenderTarget(state.renderer, target);
+    state.targetKnown = true;
+    state.target = target;
+}
+
+void setTextureTint(SDL_Texture *texture, Uint8 r, Uint8 g, Uint8 b, float alpha) {
+    textureState *s = findTextureState(texture);
+    if (s->texture == texture && s->r == r && s->g == g && s->b == b && s->alpha == alpha) {
+        state.skips++;
+        return;
+    }
+    SDL_SetTextureColorMod(texture, r, g, b);
+    SDL_SetTextureAlphaModFloat(texture, alpha);
+    *s = (textureState){texture, r, g, b, alpha};
+    state.changes++;
+}
+
+void forgetTextureState(SDL_Texture *texture) {
+    // Has to be called before destroying a texture, a new one may get the same address
+    for (int i = 0; i < TEXTURE_STATES; i++) {
+        if (state.textures[i].texture == texture)
+            state.textures[i].texture = NULL;
+    }
+    if (state.target == texture)
+        state.targetKnown = false;
+}
+
+Uint64 getRenderStateChanges(void) {
+    return state.changes;
+}
+
+Uint64 getRenderStateSkips(void) {
+    return state.skips;
+}
+
+static textureState *findTextureState(SDL_Texture *texture) {
+    for (int i = 0; i < TEXTURE_STATES; i++) {
+        if (state.textures[i].texture == texture)
+            return &state.textures[i];
+    }
+
+    // Replace the entries in turn, a forgotten tint only costs one more call
+    textureState *s = &state.textures[state.nextTexture];
+    state.nextTexture = (state.nextTexture + 1) % TEXTURE_STATES;
+    s->texture = NULL;
+    return s;
+}
+
+static bool skip(bool unchanged) {
+    if (unchanged)
+        state.skips++;
+    else
+        state.changes++;
+    return unchanged;
+}
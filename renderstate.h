@@ -0,0 +1,38 @@
+/* 
+  A fully functional SDL3 window with a custom-drawn non-client area and shadow 
+  Copyright (C) 2025 fischflocke
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef RENDERSTATE_H
+#define RENDERSTATE_H
+
+// Standard includes
+#include <stdbool.h>
+
+// SDL3 includes
+#include <SDL3/SDL.h>
+
+void resetRenderState(SDL_Renderer *renderer);
+void setDrawColor(SDL_Color color);
+void setDrawBlendMode(SDL_BlendMode mode);
+void setClipRect(const SDL_Rect *rect);
+void setRenderTarget(SDL_Texture *target);
+void setTextureTint(SDL_Texture *texture, Uint8 r, Uint8 g, Uint8 b, float alpha);
+void forgetTextureState(SDL_Texture *texture);
+Uint64 getRenderStateChanges(void);
+Uint64 getRenderStateSkips(void);
+
+#endif
@@ -0,0 +1,299 @@
+/* 
+  A fully functional SDL3 window with a custom-drawn non-client area and shadow 
+  Copyright (C) 2025 fischflocke
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Standard includes
+#include <stdbool.h>
+
+// SDL3 includes
+#include <SDL3/SDL.h>
+#include <SDL3/SDL_opengl.h>
+
+// Local includes
+#include "rendertune.h"
+#include "trace.h"
+
+// Number of timed frames per driver, after one untimed frame that warms up its caches
+#define BENCHMARK_FRAMES 10
+
+// glGetString, looked up at runtime since the renderer loads OpenGL itself
+typedef const GLubyte *(APIENTRY *getStringFunc)(GLenum name);
+
+// The cached choice, and the GPU it was measured on
+typedef struct {
+    char driver[64];
+    char gpu[256];
+} cacheEntry;
+
+// What a benchmark frame draws, offscreen at the window's size
+typedef struct {
+    SDL_Renderer *renderer;
+    SDL_Texture *tile;
+    int w;
+    int h;
+} benchmarkScene;
+
+static const char *benchmarkDrivers(SDL_Window *window);
+static void getFingerprint(char *fingerprint, size_t size);
+static void getGPUName(SDL_Renderer *renderer, char *name, size_t size);
+static char *getCachePath(void);
+static bool readCache(const char *path, const char *fingerprint, cacheEntry *entry);
+static void writeCache(const char *path, const char *fingerprint, const char *driver,
+                       const char *gpu);
+static Uint64 benchmarkDriver(SDL_Window *window, const char *driver);
+static void drawBenchmarkFrame(void *data);
+
+/* Creates a renderer with the driver that drew the chrome fastest on this machine. The choice is
+ * cached, so only the first launch or one after the machine, SDL or the GPU changed pays for the
+ * benchmark. Falls back to SDL's choice if the chosen driver fails. */
+SDL_Renderer *createTunedRenderer(SDL_Window *window) {
+    // Nothing to choose from
+    if (SDL_GetNumRenderDrivers() < 2)
+        return SDL_CreateRenderer(window, NULL);
+
+    char fingerprint[512], gpu[256];
+    getFingerprint(fingerprint, sizeof(fingerprint));
+    char *path = getCachePath();
+    cacheEntry cached;
+    SDL_Renderer *renderer = NULL;
+
+    /* The fingerprint is cheap to take, but doesn't see the GPU. That is only known once the
+     * renderer exists, so the cached driver is kept if it still runs on the GPU it was measured
+     * on. */
+    if (path && readCache(path, fingerprint, &cached)) {
+        renderer = SDL_CreateRenderer(window, cached.driver);
+        if (!renderer) {
+            SDL_Log("Failed to create %s renderer: %s", cached.driver, SDL_GetError());
+        } else {
+            getGPUName(renderer, gpu, sizeof(gpu));
+            if (SDL_strcmp(gpu, cached.gpu) == 0) {
+                SDL_free(path);
+                return renderer;
+            }
+            SDL_Log("The GPU changed to %s, benchmarking the render drivers again", gpu);
+            SDL_DestroyRenderer(renderer);
+        }
+    }
+
+    // Measure again, and remember the fastest driver with the GPU it ran on
+    const char *driver = benchmarkDrivers(window);
+    renderer = driver ? SDL_CreateRenderer(window, driver) : NULL;
+    if (renderer) {
+        getGPUName(renderer, gpu, sizeof(gpu));
+        if (path)
+            writeCache(path, fingerprint, driver, gpu);
+    } else {
+        // Don't keep a choice that doesn't work, and let SDL choose
+        if (driver)
+            SDL_Log("Failed to create %s renderer: %s", driver, SDL_GetError());
+        if (path)
+            SDL_RemovePath(path);
+        renderer = SDL_CreateRenderer(window, NULL);
+    }
+    SDL_free(path);
+    return renderer;
+}
+
+/* Times drawing frames as fast as the GPU goes, so vsync has to be off for a window. Reading back a
+ * pixel waits until the GPU has actually drawn a frame, and the first one only warms up caches.
+ * Returns the time of the others in nanoseconds, or 0 if reading back failed. */
+Uint64 timeFrames(SDL_Renderer *renderer, int frames, void (*draw)(void *data), void *data) {
+    Uint64 time = 0;
+    for (int i = 0; i <= frames; i++) {
+        Uint64 start = SDL_GetTicksNS();
+        draw(data);
+        SDL_Surface *pixel = SDL_RenderReadPixels(renderer, &(SDL_Rect){0, 0, 1, 1});
+        if (!pixel)
+            return 0;
+        SDL_DestroySurface(pixel);
+        if (i > 0)
+            time += SDL_GetTicksNS() - start;
+    }
+    return time;
+}
+
+static const char *benchmarkDrivers(SDL_Window *window) {
+    // Try every driver, the window is still hidden
+    Uint64 start = traceNow();
+    Uint64 best = 0;
+    const char *driver = NULL;
+    for (int i = 0; i < SDL_GetNumRenderDrivers(); i++) {
+        const char *name = SDL_GetRenderDriver(i);
+        Uint64 time = benchmarkDriver(window, name);
+        if (!time) {
+            SDL_Log("Render driver %s: unavailable", name);
+            continue;
+        }
+        SDL_Log("Render driver %s: %.3f ms per frame", name, time / 1e6 / BENCHMARK_FRAMES);
+        if (!best || time < best) {
+            best = time;
+            driver = name;
+        }
+    }
+    traceSpan("renderer benchmark", start, traceNow());
+    return driver;
+}
+
+static void getFingerprint(char *fingerprint, size_t size) {
+    /* The machine is identified by what SDL can tell about it without creating a renderer: the
+     * platform, CPU and memory, the video driver and primary display, SDL's version and its
+     * render drivers. Deleting the cache file forces a new benchmark. */
+    int version = SDL_GetVersion();
+    const char *video = SDL_GetCurrentVideoDriver();
+    const char *display = SDL_GetDisplayName(SDL_GetPrimaryDisplay());
+    SDL_snprintf(fingerprint, size, "%s-%d-%d-%d.%d.%d-%s-%s", SDL_GetPlatform(),
+                 SDL_GetNumLogicalCPUCores(), SDL_GetSystemRAM(), SDL_VERSIONNUM_MAJOR(version),
+                 SDL_VERSIONNUM_MINOR(version), SDL_VERSIONNUM_MICRO(version),
+                 video ? video : "none", display ? display : "none");
+    for (int i = 0; i < SDL_GetNumRenderDrivers(); i++) {
+        SDL_strlcat(fingerprint, i ? "," : "-", size);
+        SDL_strlcat(fingerprint, SDL_GetRenderDriver(i), size);
+    }
+}
+
+static void getGPUName(SDL_Renderer *renderer, char *name, size_t size) {
+    /* Only OpenGL names the GPU and its driver version, the other backends just hand out native
+     * device handles. For them the renderer's name and texture limit stand in for the GPU. */
+    SDL_snprintf(name, size, "%s/%d", SDL_GetRendererName(renderer),
+                 (int)SDL_GetNumberProperty(SDL_GetRendererProperties(renderer),
+                                            SDL_PROP_RENDERER_MAX_TEXTURE_SIZE_NUMBER, 0));
+    getStringFunc getString = NULL;
+    if (SDL_strcmp(SDL_GetRendererName(renderer), "opengl") == 0)
+        getString = (getStringFunc)SDL_GL_GetProcAddress("glGetString");
+    if (getString) {
+        // The renderer's context is current right after creating it
+        const GLenum strings[3] = {GL_VENDOR, GL_RENDERER, GL_VERSION};
+        for (int i = 0; i < 3; i++) {
+            const char *value = (const char *)getString(strings[i]);
+            SDL_strlcat(name, "/", size);
+            SDL_strlcat(name, value ? value : "", size);
+        }
+    }
+}
+
+static char *getCachePath(void) {
+    char *dir = SDL_GetPrefPath("fischflocke", "Demo-Window");
+    if (!dir)
+        return NULL;
+    char *path;
+    SDL_asprintf(&path, "%srenderer.cache", dir);
+    SDL_free(dir);
+    return path;
+}
+
+static bool readCache(const char *path, const char *fingerprint, cacheEntry *entry) {
+    // The cache has a line each for the fingerprint, the driver and the GPU, which contain spaces
+    char *cache = SDL_LoadFile(path, NULL);
+    if (!cache)
+        return false;
+    char *lines[3] = {cache, NULL, NULL};
+    for (int i = 0; i < 3 && lines[i]; i++) {
+        char *end = SDL_strchr(lines[i], '\n');
+        if (end) {
+            *end = '\0';
+            if (end > lines[i] && end[-1] == '\r')
+                end[-1] = '\0';
+            if (i < 2)
+                lines[i + 1] = end + 1;
+        }
+    }
+
+    // Only use a driver that still exists
+    bool found = false;
+    if (lines[2] && SDL_strcmp(lines[0], fingerprint) == 0) {
+        for (int i = 0; i < SDL_GetNumRenderDrivers() && !found; i++)
+            found = SDL_strcmp(SDL_GetRenderDriver(i), lines[1]) == 0;
+    }
+    if (found) {
+        SDL_strlcpy(entry->driver, lines[1], sizeof(entry->driver));
+        SDL_strlcpy(entry->gpu, lines[2], sizeof(entry->gpu));
+    }
+    SDL_free(cache);
+    return found;
+}
+
+static void writeCache(const char *path, const char *fingerprint, const char *driver,
+                       const char *gpu) {
+    SDL_IOStream *io = SDL_IOFromFile(path, "w");
+    if (!io)
+        return;
+    SDL_IOprintf(io, "%s\n%s\n%s\n", fingerprint, driver, gpu);
+    SDL_CloseIO(io);
+}
+
+static Uint64 benchmarkDriver(SDL_Window *window, const char *driver) {
+    // The window is still hidden, so only one renderer at a time is created for it
+    SDL_Renderer *renderer = SDL_CreateRenderer(window, driver);
+    if (!renderer)
+        return 0;
+
+    // Draw offscreen at the window's size, with a tile like the corner and shadow pieces
+    int w, h;
+    SDL_GetWindowSizeInPixels(window, &w, &h);
+    SDL_Texture *target = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888,
+                                            SDL_TEXTUREACCESS_TARGET, w, h);
+    SDL_Surface *pixels = SDL_CreateSurface(64, 64, SDL_PIXELFORMAT_ARGB8888);
+    SDL_Texture *tile = NULL;
+    if (pixels) {
+        SDL_FillSurfaceRect(pixels, NULL, 0x80ffffff);
+        tile = SDL_CreateTextureFromSurface(renderer, pixels);
+        SDL_DestroySurface(pixels);
+    }
+
+    Uint64 time = 0;
+    if (target && tile && SDL_SetRenderTarget(renderer, target)) {
+        benchmarkScene scene = {renderer, tile, w, h};
+        time = timeFrames(renderer, BENCHMARK_FRAMES, drawBenchmarkFrame, &scene);
+    }
+
+    SDL_DestroyTexture(tile);
+    SDL_DestroyTexture(target);
+    SDL_DestroyRenderer(renderer);
+    return time;
+}
+
+static void drawBenchmarkFrame(void *data) {
+    const benchmarkScene *scene = data;
+    SDL_Renderer *renderer = scene->renderer;
+    SDL_Texture *tile = scene->tile;
+    int w = scene->w, h = scene->h;
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    SDL_RenderClear(renderer);
+
+    // Shadow pieces, stretched along the edges
+    float m = 40;
+    SDL_FRect shadow[8] = {
+        {0, 0, m, m}, {w - m, 0, m, m}, {0, h - m, m, m}, {w - m, h - m, m, m},
+        {m, 0, w - 2 * m, m}, {m, h - m, w - 2 * m, m},
+        {0, m, m, h - 2 * m}, {w - m, m, m, h - 2 * m}
+    };
+    for (int i = 0; i < 8; i++)
+        SDL_RenderTexture(renderer, tile, NULL, &shadow[i]);
+
+    // Border, title bar and client area with their rounded corners
+    SDL_FRect area = {m, m, w - 2 * m, h - 2 * m};
+    for (int i = 0; i < 3; i++) {
+        SDL_SetRenderDrawColor(renderer, 60 * i, 60 * i, 60 * i, 255);
+        SDL_RenderFillRect(renderer, &area);
+        for (int j = 0; j < 4; j++) {
+            SDL_FRect corner = {j % 2 ? area.x + area.w - 8 : area.x,
+                                j / 2 ? area.y + area.h - 8 : area.y, 8, 8};
+            SDL_RenderTextureRotated(renderer, tile, NULL, &corner, 0, NULL, (SDL_FlipMode)j);
+        }
+        area = (SDL_FRect){area.x + 1, area.y + 1, area.w - 2, area.h - 2};
+    }
+}
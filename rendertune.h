@@ -0,0 +1,28 @@
+/* 
+  A fully functional SDL3 window with a custom-drawn non-client area and shadow 
+  Copyright (C) 2025 fischflocke
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef RENDERTUNE_H
+#define RENDERTUNE_H
+
+// SDL3 includes
+#include <SDL3/SDL.h>
+
+SDL_Renderer *createTunedRenderer(SDL_Window *window);
+Uint64 timeFrames(SDL_Renderer *renderer, int frames, void (*draw)(void *data), void *data);
+
+#endif
@@ -0,0 +1,256 @@
+/* 
+  A fully functional SDL3 window with a custom-drawn non-client area and shadow 
+  Copyright (C) 2025 fischflocke
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Standard includes
+#include <stdbool.h>
+#include <stdio.h>
+
+// Platform includes
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// SDL3 includes
+#include <SDL3/SDL.h>
+
+// Local includes
+#include "alloc.h"
+#include "cursor.h"
+#include "pacing.h"
+#include "renderstate.h"
+#include "stats.h"
+#include "trace.h"
+
+// Number of histogram buckets, bucket i counts durations below 2^i microseconds
+#define HISTOGRAM_BUCKETS 24
+
+typedef struct {
+    Uint64 count;
+    Uint64 total;
+    Uint64 max;
+    Uint64 buckets[HISTOGRAM_BUCKETS];
+} histogram;
+
+static void recordHistogram(histogram *h, Uint64 ns);
+static void writeHistogram(SDL_IOStream *io, int indent, const char *name, const histogram *h,
+                           bool last);
+static Uint64 getPeakRSS(void);
+
+/* Startup stages as named in the trace, and their keys in the report. The time to the first
+ * present spans from the trace's origin, which is the process start where available. */
+static const char *stages[][2] = {
+    {"sdl_init", "SDL init"},
+    {"ttf_init", "TTF init"},
+    {"window", "window"},
+    {"renderer", "renderer"},
+    {"asset_decode", "image decode"},
+    {"asset_upload", "texture upload"},
+    {"first_layout", "layout"},
+    {"first_present", "first frame"},
+    {"time_to_first_present", "startup"}
+};
+
+/* Latency from an event to the present that showed it, by the kind of event. Names must be string
+ * literals or otherwise outlive the stats. */
+typedef struct {
+    const char *cause;
+    histogram latency;
+    // Number of events shown within one refresh period
+    Uint64 inFrame;
+} causeLatency;
+
+// Counters of the main thread, cheap enough to always be recorded
+static struct {
+    histogram frames;
+    histogram hitTests;
+    causeLatency latencies[16];
+    int causes;
+    Uint64 layouts;
+    // Frames that only redrew damaged caption buttons
+    Uint64 partialFrames;
+    Uint64 idleWakeups;
+} stats;
+
+void recordFrame(Uint64 ns) {
+    recordHistogram(&stats.frames, ns);
+}
+
+void recordPartialFrame(void) {
+    stats.partialFrames++;
+}
+
+Uint64 getFrameCount(void) {
+    return stats.frames.count;
+}
+
+Uint64 getPartialFrameCount(void) {
+    return stats.partialFrames;
+}
+
+Uint64 getLayoutCount(void) {
+    return stats.layouts;
+}
+
+void recordLayout(void) {
+    stats.layouts++;
+}
+
+void recordHitTest(Uint64 ns) {
+    recordHistogram(&stats.hitTests, ns);
+}
+
+void recordLatency(const char *cause, Uint64 ns) {
+    causeLatency *c = NULL;
+    for (int i = 0; i < stats.causes && !c; i++) {
+        if (SDL_strcmp(stats.latencies[i].cause, cause) == 0)
+            c = &stats.latencies[i];
+    }
+    if (!c) {
+        if (stats.causes == (int)SDL_arraysize(stats.latencies))
+            return;
+        c = &stats.latencies[stats.causes++];
+        c->cause = cause;
+    }
+
+    recordHistogram(&c->latency, ns);
+    if (ns <= SDL_NS_PER_SECOND / getRefreshRate())
+        c->inFrame++;
+}
+
+void recordIdleWakeup(void) {
+    stats.idleWakeups++;
+}
+
+bool writeStats(const char *path) {
+    // Without a path the report is collected in memory and printed at once
+    SDL_IOStream *io = path ? SDL_IOFromFile(path, "w") : SDL_IOFromDynamicMem();
+    if (!io)
+        return false;
+
+    SDL_IOprintf(io, "{\n  \"startup_ms\": {");
+    for (size_t i = 0; i < SDL_arraysize(stages); i++) {
+        SDL_IOprintf(io, "%s\n    \"%s\": %.3f", i ? "," : "", stages[i][0],
+                     getTraceDuration(stages[i][1]) / 1e6);
+    }
+    SDL_IOprintf(io, "\n  },\n");
+
+    SDL_IOprintf(io, "  \"frames\": %" SDL_PRIu64 ",\n", stats.frames.count);
+    SDL_IOprintf(io, "  \"partial_frames\": %" SDL_PRIu64 ",\n", stats.partialFrames);
+    writeHistogram(io, 2, "frame_time", &stats.frames, false);
+    SDL_IOprintf(io, "  \"refresh_rate\": %.3f,\n", getRefreshRate());
+    SDL_IOprintf(io, "  \"missed_deadlines\": %" SDL_PRIu64 ",\n", getMissedFrames());
+    SDL_IOprintf(io, "  \"layouts\": %" SDL_PRIu64 ",\n", stats.layouts);
+
+    // Latency from each kind of event to the present that showed it
+    SDL_IOprintf(io, "  \"input_to_present\": {");
+    for (int i = 0; i < stats.causes; i++) {
+        const causeLatency *c = &stats.latencies[i];
+        SDL_IOprintf(io, "%s\n    \"%s\": {\n", i ? "," : "", c->cause);
+        SDL_IOprintf(io, "      \"count\": %" SDL_PRIu64 ",\n", c->latency.count);
+        SDL_IOprintf(io, "      \"within_a_frame\": %" SDL_PRIu64 ",\n", c->inFrame);
+        writeHistogram(io, 6, "latency", &c->latency, true);
+        SDL_IOprintf(io, "    }");
+    }
+    SDL_IOprintf(io, "\n  },\n");
+
+    SDL_IOprintf(io, "  \"hit_tests\": %" SDL_PRIu64 ",\n", stats.hitTests.count);
+    writeHistogram(io, 2, "hit_test_latency", &stats.hitTests, false);
+    SDL_IOprintf(io, "  \"idle_wakeups\": %" SDL_PRIu64 ",\n", stats.idleWakeups);
+
+    SDL_IOprintf(io, "  \"cursors\": {\"switches\": %" SDL_PRIu64 ", \"created_on_demand\": %"
+                 SDL_PRIu64 "},\n", getCursorSwitches(), getCursorMisses());
+    SDL_IOprintf(io, "  \"render_state\": {\"changes\": %" SDL_PRIu64 ", \"skipped\": %"
+                 SDL_PRIu64 "},\n", getRenderStateChanges(), getRenderStateSkips());
+
+    SDL_IOprintf(io, "  \"allocations\": {");
+    for (int i = 0; i < ALLOC_PHASES; i++) {
+        SDL_IOprintf(io, "%s\n    \"%s\": {\"count\": %" SDL_PRIu64 ", \"bytes\": %"
+                     SDL_PRIu64 "}", i ? "," : "", getAllocPhaseName(i), getAllocCount(i),
+                     getAllocBytes(i));
+    }
+    SDL_IOprintf(io, "\n  },\n");
+    SDL_IOprintf(io, "  \"peak_rss_bytes\": %" SDL_PRIu64 "\n}\n", getPeakRSS());
+
+    bool written = SDL_GetIOStatus(io) != SDL_IO_STATUS_ERROR;
+    if (written && !path) {
+        const char *report = SDL_GetPointerProperty(SDL_GetIOProperties(io),
+                                                    SDL_PROP_IOSTREAM_DYNAMIC_MEMORY_POINTER,
+                                                    NULL);
+        size_t size = SDL_TellIO(io);
+        written = !size || fwrite(report, 1, size, stdout) == size;
+        fflush(stdout);
+    }
+    return SDL_CloseIO(io) && written;
+}
+
+static void recordHistogram(histogram *h, Uint64 ns) {
+    h->count++;
+    h->total += ns;
+    h->max = SDL_max(h->max, ns);
+
+    // Find the first power of two above the duration in microseconds
+    Uint64 us = ns / 1000;
+    int bucket = 0;
+    while (bucket < HISTOGRAM_BUCKETS - 1 && us >= (Uint64)1 << bucket)
+        bucket++;
+    h->buckets[bucket]++;
+}
+
+static void writeHistogram(SDL_IOStream *io, int indent, const char *name, const histogram *h,
+                           bool last) {
+    SDL_IOprintf(io, "%*s\"%s\": {\n", indent, "", name);
+    SDL_IOprintf(io, "%*s\"mean_us\": %.3f,\n", indent + 2, "",
+                 h->count ? h->total / 1e3 / h->count : 0.0);
+    SDL_IOprintf(io, "%*s\"max_us\": %.3f,\n", indent + 2, "", h->max / 1e3);
+
+    // Upper bounds of the buckets, the last one is open
+    SDL_IOprintf(io, "%*s\"bucket_below_us\": [", indent + 2, "");
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        if (i < HISTOGRAM_BUCKETS - 1)
+            SDL_IOprintf(io, "%s%" SDL_PRIu64, i ? ", " : "", (Uint64)1 << i);
+        else
+            SDL_IOprintf(io, ", null");
+    }
+    SDL_IOprintf(io, "],\n%*s\"counts\": [", indent + 2, "");
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++)
+        SDL_IOprintf(io, "%s%" SDL_PRIu64, i ? ", " : "", h->buckets[i]);
+    SDL_IOprintf(io, "]\n%*s}%s\n", indent, "", last ? "" : ",");
+}
+
+static Uint64 getPeakRSS(void) {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return 0;
+    return counters.PeakWorkingSetSize;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#ifdef __APPLE__
+    // Bytes on macOS
+    return usage.ru_maxrss;
+#else
+    // Kilobytes everywhere else
+    return (Uint64)usage.ru_maxrss * 1024;
+#endif
+#endif
+}
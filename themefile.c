@@ -0,0 +1,191 @@
+/* 
+  A fully functional SDL3 window with a custom-drawn non-client area and shadow 
+  Copyright (C) 2025 fischflocke
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Standard includes
+#include <stdbool.h>
+
+// Platform includes
+#ifdef __linux__
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+// SDL3 includes
+#include <SDL3/SDL.h>
+
+// Local includes
+#include "palette.h"
+#include "themefile.h"
+#include "trace.h"
+
+// Both palettes, as parsed from the file
+typedef struct {
+    palette light;
+    palette dark;
+} themePalettes;
+
+static void reloadThemeFile(void);
+#ifdef __linux__
+static int watchFile(void *data);
+#endif
+
+/* The file is watched from a background thread, which parses it on every change and publishes the
+ * result with a single atomic pointer swap. The main thread takes it when it gets the event. */
+static struct {
+    const char *path;
+    // Colors that aren't in the file
+    themePalettes defaults;
+    Uint32 event;
+    SDL_Thread *watcher;
+    SDL_AtomicInt stop;
+    // Wakes the watcher when it should stop
+    int wake;
+    void *pending;
+} themeFile;
+
+bool loadThemeFile(const char *path, palette *light, palette *dark) {
+    Uint64 start = traceNow();
+    /* Parse a copy instead of a mapping, an editor truncating the file while it's parsed would
+     * otherwise crash the watcher with SIGBUS */
+    size_t size;
+    char *data = SDL_LoadFile(path, &size);
+    if (!data)
+        return false;
+    bool parsed = parsePalettes(data, size, light, dark);
+    SDL_free(data);
+    traceSpan("theme file", start, traceNow());
+    return parsed;
+}
+
+bool watchThemeFile(const char *path, const palette *light, const palette *dark) {
+#ifdef __linux__
+    if (themeFile.watcher)
+        return true;
+
+    themeFile.path = path;
+    themeFile.defaults = (themePalettes){*light, *dark};
+    themeFile.event = SDL_RegisterEvents(1);
+    themeFile.wake = eventfd(0, EFD_CLOEXEC);
+    if (themeFile.wake < 0)
+        return SDL_SetError("Failed to create an eventfd");
+    themeFile.watcher = SDL_CreateThread(watchFile, "theme watcher", NULL);
+    if (!themeFile.watcher) {
+        close(themeFile.wake);
+        return false;
+    }
+    return true;
+#else
+    return SDL_SetError("Watching the theme file is only supported on Linux");
+#endif
+}
+
+void unwatchThemeFile(void) {
+    if (!themeFile.watcher)
+        return;
+    SDL_SetAtomicInt(&themeFile.stop, 1);
+#ifdef __linux__
+    eventfd_write(themeFile.wake, 1);
+#endif
+    SDL_WaitThread(themeFile.watcher, NULL);
+    themeFile.watcher = NULL;
+#ifdef __linux__
+    close(themeFile.wake);
+#endif
+    SDL_free(SDL_SetAtomicPointer(&themeFile.pending, NULL));
+}
+
+bool isThemeFileEvent(const SDL_Event *event) {
+    return themeFile.event && event->type == themeFile.event;
+}
+
+bool takeThemePalettes(palette *light, palette *dark) {
+    themePalettes *p = SDL_SetAtomicPointer(&themeFile.pending, NULL);
+    if (!p)
+        return false;
+    *light = p->light;
+    *dark = p->dark;
+    SDL_free(p);
+    return true;
+}
+
+static void reloadThemeFile(void) {
+    themePalettes *p = SDL_malloc(sizeof(*p));
+    if (!p)
+        return;
+    *p = themeFile.defaults;
+    if (!loadThemeFile(themeFile.path, &p->light, &p->dark)) {
+        // Keep the current palettes, the file may still be written
+        SDL_Log("Failed to reload %s: %s", themeFile.path, SDL_GetError());
+        SDL_free(p);
+        return;
+    }
+
+    // Replace palettes the main thread hasn't taken yet
+    SDL_free(SDL_SetAtomicPointer(&themeFile.pending, p));
+    SDL_Event event = {.type = themeFile.event};
+    SDL_PushEvent(&event);
+}
+
+#ifdef __linux__
+static int watchFile(void *data) {
+    int fd = inotify_init1(IN_CLOEXEC);
+    if (fd < 0)
+        return 0;
+
+    // Watch the directory, as editors often replace the file instead of writing to it
+    char *dir = SDL_strdup(themeFile.path);
+    char *slash = dir ? SDL_strrchr(dir, '/') : NULL;
+    const char *name = slash ? slash + 1 : themeFile.path;
+    if (slash)
+        *slash = '\0';
+    const char *watched = !slash ? "." : slash == dir ? "/" : dir;
+    if (inotify_add_watch(fd, watched, IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        SDL_free(dir);
+        close(fd);
+        return 0;
+    }
+
+    // Sleep until the file changes or the app exits
+    union {
+        struct inotify_event event;
+        char bytes[4096];
+    } buffer;
+    struct pollfd fds[2] = {{fd, POLLIN, 0}, {themeFile.wake, POLLIN, 0}};
+    while (!SDL_GetAtomicInt(&themeFile.stop)) {
+        if (poll(fds, 2, -1) <= 0 || !(fds[0].revents & POLLIN))
+            continue;
+        ssize_t len = read(fd, buffer.bytes, sizeof(buffer.bytes));
+
+        bool changed = false;
+        for (ssize_t i = 0; i < len;) {
+            const struct inotify_event *event = (const void *)(buffer.bytes + i);
+            if (event->len && SDL_strcmp(event->name, name) == 0)
+                changed = true;
+            i += sizeof(*event) + event->len;
+        }
+        if (changed)
+            reloadThemeFile();
+    }
+
+    SDL_free(dir);
+    close(fd);
+    return 0;
+}
+#endif
@@ -0,0 +1,224 @@
+/* 
+  A fully functional SDL3 window with a custom-drawn non-client area and shadow 
+  Copyright (C) 2025 fischflocke
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Standard includes
+#include <math.h>
+#include <stdbool.h>
+
+// SDL3 includes
+#include <SDL3/SDL.h>
+#include <SDL3_ttf/SDL_ttf.h>
+
+// Local includes
+#include "mapfile.h"
+#include "renderstate.h"
+#include "titletext.h"
+#include "trace.h"
+
+// Font size in points at a scale of 1
+#define TITLE_FONT_SIZE 11
+
+static int loadFont(void *data);
+static bool openFont(const char *path);
+
+/* Common locations of UI fonts, used if no font is given. The first one that can be opened is
+ * used. */
+static const char *fontPaths[] = {
+    "/usr/share/fonts/cantarell/Cantarell-VF.otf",
+    "/usr/share/fonts/abattis-cantarell-vf-fonts/Cantarell-VF.otf",
+    "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf",
+    "/usr/share/fonts/dejavu-sans-fonts/DejaVuSans.ttf",
+    "/usr/share/fonts/TTF/DejaVuSans.ttf",
+    "/usr/share/fonts/noto/NotoSans-Regular.ttf",
+    "/usr/share/fonts/truetype/noto/NotoSans-Regular.ttf",
+    "/System/Library/Fonts/SFNS.ttf",
+    "/System/Library/Fonts/Helvetica.ttc",
+    "C:\\Windows\\Fonts\\segoeui.ttf"
+};
+
+/* The text is shaped by SDL3_ttf only when its string or the font size changes. Its glyphs live in
+ * the text engine's shared atlas, so a redraw just replays the cached draw sequence.
+ *
+ * SDL3_ttf itself is only initialized when the font is loaded, which happens on a background
+ * thread after the first frame has been presented, so FreeType and HarfBuzz never delay it. */
+static struct {
+    // Background loading
+    SDL_Thread *loader;
+    SDL_AtomicInt loaded;
+    Uint32 event;
+    const char *fontPath;
+    bool ttfInitialized;
+    // Font, memory-mapped instead of read
+    void *fontData;
+    size_t fontSize;
+    TTF_Font *font;
+    // Text
+    TTF_TextEngine *engine;
+    TTF_Text *text;
+    char *title;
+    float scale;
+    SDL_Color color;
+} title;
+
+void loadTitleFont(const char *fontPath) {
+    if (title.loader || title.font)
+        return;
+
+    // The loader announces the font with this event
+    title.event = SDL_RegisterEvents(1);
+    title.fontPath = fontPath;
+    title.loader = SDL_CreateThread(loadFont, "font", NULL);
+}
+
+bool isTitleFontEvent(const SDL_Event *event) {
+    return title.event && event->type == title.event;
+}
+
+bool finishTitleText(SDL_Renderer *renderer) {
+    // Only possible once the loader is done
+    if (!title.loader || !SDL_GetAtomicInt(&title.loaded))
+        return false;
+    SDL_WaitThread(title.loader, NULL);
+    title.loader = NULL;
+    if (!title.font)
+        return false;
+
+    Uint64 start = traceNow();
+    title.engine = TTF_CreateRendererTextEngine(renderer);
+    if (title.engine)
+        title.text = TTF_CreateText(title.engine, title.font, "", 0);
+    traceSpan("text engine", start, traceNow());
+
+    return title.text != NULL;
+}
+
+void destroyTitleText(void) {
+    // Wait for the loader, it may still be opening the font
+    if (title.loader)
+        SDL_WaitThread(title.loader, NULL);
+
+    if (title.text)
+        TTF_DestroyText(title.text);
+    if (title.engine)
+        TTF_DestroyRendererTextEngine(title.engine);
+    if (title.font)
+        TTF_CloseFont(title.font);
+    if (title.fontData)
+        unmapFile(title.fontData, title.fontSize);
+    if (title.ttfInitialized)
+        TTF_Quit();
+    SDL_free(title.title);
+    SDL_zero(title);
+}
+
+void updateTitleText(const char *string, float scale) {
+    if (!title.text)
+        return;
+
+    // Scale the font with the display, which makes SDL3_ttf reshape the text on its own
+    if (scale != title.scale) {
+        TTF_SetFontSize(title.font, TITLE_FONT_SIZE * scale);
+        title.scale = scale;
+    }
+
+    // Only reshape if the title really changed
+    if (!string)
+        string = "";
+    if (title.title && SDL_strcmp(string, title.title) == 0)
+        return;
+    SDL_free(title.title);
+    title.title = SDL_strdup(string);
+    TTF_SetTextString(title.text, string, 0);
+}
+
+void drawTitleText(const SDL_Rect *titleBar, SDL_Color color) {
+    if (!title.text || !title.title || !*title.title)
+        return;
+
+    if (SDL_memcmp(&color, &title.color, sizeof(color)) != 0) {
+        TTF_SetTextColor(title.text, color.r, color.g, color.b, color.a);
+        title.color = color;
+    }
+
+    // Center the text, or align it to the left with some padding if it's too wide
+    int w, h;
+    TTF_GetTextSize(title.text, &w, &h);
+    int padding = ceilf(10 * title.scale);
+    if (titleBar->w <= 2 * padding)
+        return;
+    int x = titleBar->x + (titleBar->w - w) / 2;
+    int y = titleBar->y + (titleBar->h - h) / 2;
+    bool clip = w > titleBar->w - 2 * padding;
+    if (clip)
+        x = titleBar->x + padding;
+
+    if (clip) {
+        SDL_Rect area = {titleBar->x + padding, titleBar->y, titleBar->w - 2 * padding,
+                         titleBar->h};
+        setClipRect(&area);
+    }
+    TTF_DrawRendererText(title.text, x, y);
+    if (clip)
+        setClipRect(NULL);
+}
+
+static int loadFont(void *data) {
+    Uint64 start = traceNow();
+
+    // Init SDL3_ttf
+    if (TTF_Init()) {
+        title.ttfInitialized = true;
+        traceSpan("TTF init", start, traceNow());
+
+        // Open the given font or the first available system font
+        Uint64 fontStart = traceNow();
+        if (title.fontPath) {
+            openFont(title.fontPath);
+        } else {
+            for (size_t i = 0; i < SDL_arraysize(fontPaths) && !title.font; i++)
+                openFont(fontPaths[i]);
+        }
+        traceSpan("font load", fontStart, traceNow());
+    }
+
+    // Hand the font over to the main thread
+    SDL_SetAtomicInt(&title.loaded, 1);
+    SDL_Event event = {.type = title.event};
+    SDL_PushEvent(&event);
+    return 0;
+}
+
+static bool openFont(const char *path) {
+    size_t size;
+    void *data = mapFile(path, &size);
+    if (!data)
+        return false;
+
+    // Open the font straight from the mapped file, so only the pages FreeType touches are read
+    TTF_Font *font = TTF_OpenFontIO(SDL_IOFromConstMem(data, size), true, TITLE_FONT_SIZE);
+    if (!font) {
+        unmapFile(data, size);
+        return false;
+    }
+
+    title.font = font;
+    title.fontData = data;
+    title.fontSize = size;
+    title.scale = 1;
+    return true;
+}
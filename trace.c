@@ -0,0 +1,201 @@
+/* 
+  A fully functional SDL3 window with a custom-drawn non-client area and shadow 
+  Copyright (C) 2025 fischflocke
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Standard includes
+#include <stdbool.h>
+
+// Platform includes
+#ifdef __linux__
+#include <time.h>
+#include <unistd.h>
+#endif
+
+// SDL3 includes
+#include <SDL3/SDL.h>
+
+// Local includes
+#include "trace.h"
+
+// Maximum number of recorded spans, later ones are dropped
+#define TRACE_CAPACITY 4096
+
+/* Spans are recorded into a fixed buffer, so tracing never allocates and works from any thread.
+ * Names must be string literals or otherwise outlive the trace. */
+typedef struct {
+    const char *name;
+    Uint64 start;
+    Uint64 end;
+    Uint64 thread;
+    // Flows are drawn as arrows from the start to the end instead of as a block
+    bool flow;
+} span;
+
+static void addSpan(const char *name, Uint64 start, Uint64 end, bool flow);
+static const span *getSpan(int i);
+static Sint64 getProcessAge(void);
+
+/* Timestamps are SDL ticks. The origin is the start of the process where it can be determined,
+ * so the trace also covers loading the executable and its libraries. */
+static struct {
+    Sint64 origin;
+    // Replacement of SDL's clock, such as a script's virtual one
+    Uint64 (*clock)(void);
+    SDL_AtomicInt count;
+    span spans[TRACE_CAPACITY];
+} trace;
+
+void initTrace(void) {
+    Uint64 now = SDL_GetTicksNS();
+    Sint64 age = getProcessAge();
+    trace.origin = (Sint64)now - age;
+    if (age > 0)
+        traceSpan("process start", trace.origin, now);
+}
+
+Uint64 traceNow(void) {
+    return trace.clock ? trace.clock() : SDL_GetTicksNS();
+}
+
+void setTraceClock(Uint64 (*clock)(void)) {
+    trace.clock = clock;
+}
+
+Sint64 traceOrigin(void) {
+    return trace.origin;
+}
+
+void traceSpan(const char *name, Uint64 start, Uint64 end) {
+    addSpan(name, start, end, false);
+}
+
+void traceFlow(const char *name, Uint64 start, Uint64 end) {
+    addSpan(name, start, end, true);
+}
+
+static void addSpan(const char *name, Uint64 start, Uint64 end, bool flow) {
+    // Reserve a slot, the count stops at the capacity instead of growing for the whole session
+    int i;
+    do {
+        i = SDL_GetAtomicInt(&trace.count);
+        if (i >= TRACE_CAPACITY)
+            return;
+    } while (!SDL_CompareAndSwapAtomicInt(&trace.count, i, i + 1));
+    span *s = &trace.spans[i];
+    s->start = start;
+    s->end = end;
+    s->thread = SDL_GetCurrentThreadID();
+    s->flow = flow;
+    // The name marks the span as complete for readers on other threads
+    SDL_MemoryBarrierRelease();
+    s->name = name;
+}
+
+static const span *getSpan(int i) {
+    const span *s = &trace.spans[i];
+    if (!s->name)
+        return NULL;
+    SDL_MemoryBarrierAcquire();
+    return s;
+}
+
+Uint64 getTraceDuration(const char *name) {
+    // Duration of the first span with that name
+    int count = SDL_min(SDL_GetAtomicInt(&trace.count), TRACE_CAPACITY);
+    for (int i = 0; i < count; i++) {
+        const span *s = getSpan(i);
+        if (s && !s->flow && SDL_strcmp(s->name, name) == 0)
+            return s->end - s->start;
+    }
+    return 0;
+}
+
+void printTrace(void) {
+    int count = SDL_min(SDL_GetAtomicInt(&trace.count), TRACE_CAPACITY);
+    for (int i = 0; i < count; i++) {
+        const span *s = getSpan(i);
+        if (!s || s->flow)
+            continue;
+        SDL_Log("%8.3f ms  +%8.3f ms  %s", ((Sint64)s->start - trace.origin) / 1e6,
+                (s->end - s->start) / 1e6, s->name);
+    }
+}
+
+bool writeTrace(const char *path) {
+    SDL_IOStream *io = SDL_IOFromFile(path, "w");
+    if (!io)
+        return false;
+
+    // Chrome trace event format, which can be opened in Perfetto or chrome://tracing
+    int count = SDL_min(SDL_GetAtomicInt(&trace.count), TRACE_CAPACITY);
+    SDL_IOprintf(io, "{\"traceEvents\":[");
+    bool first = true;
+    for (int i = 0; i < count; i++) {
+        const span *s = getSpan(i);
+        if (!s)
+            continue;
+        double ts = ((Sint64)s->start - trace.origin) / 1e3, dur = (s->end - s->start) / 1e3;
+        if (s->flow) {
+            // Flow events have to be bound to slices, so the arrow connects two short ones
+            const char *comma = first ? "" : ",";
+            SDL_IOprintf(io, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%"
+                         SDL_PRIu64 ",\"ts\":%.3f,\"dur\":1}", comma, s->name, s->thread, ts);
+            SDL_IOprintf(io, ",\n{\"name\":\"%s\",\"cat\":\"latency\",\"ph\":\"s\",\"id\":%d,"
+                         "\"pid\":1,\"tid\":%" SDL_PRIu64 ",\"ts\":%.3f}", s->name, i, s->thread,
+                         ts);
+            SDL_IOprintf(io, ",\n{\"name\":\"present\",\"ph\":\"X\",\"pid\":1,\"tid\":%"
+                         SDL_PRIu64 ",\"ts\":%.3f,\"dur\":1}", s->thread, ts + dur - 1);
+            SDL_IOprintf(io, ",\n{\"name\":\"%s\",\"cat\":\"latency\",\"ph\":\"f\",\"bp\":\"e\","
+                         "\"id\":%d,\"pid\":1,\"tid\":%" SDL_PRIu64 ",\"ts\":%.3f}", s->name, i,
+                         s->thread, ts + dur - 1);
+        } else {
+            SDL_IOprintf(io, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%" SDL_PRIu64
+                         ",\"ts\":%.3f,\"dur\":%.3f}", first ? "" : ",", s->name, s->thread, ts,
+                         dur);
+        }
+        first = false;
+    }
+    SDL_IOprintf(io, "\n]}\n");
+
+    return SDL_CloseIO(io);
+}
+
+static Sint64 getProcessAge(void) {
+#ifdef __linux__
+    // The process' start time in clock ticks since boot is the 22nd field of its stat file
+    size_t size;
+    char *stat = SDL_LoadFile("/proc/self/stat", &size);
+    if (!stat)
+        return 0;
+
+    // Skip the command name, which may contain spaces, and the fields up to the start time
+    const char *p = SDL_strrchr(stat, ')');
+    for (int field = 2; p && field < 22; field++)
+        p = SDL_strchr(p + 1, ' ');
+    unsigned long long ticks = p ? SDL_strtoull(p + 1, NULL, 10) : 0;
+    SDL_free(stat);
+    if (!ticks)
+        return 0;
+
+    struct timespec now;
+    clock_gettime(CLOCK_BOOTTIME, &now);
+    Sint64 start = ticks * SDL_NS_PER_SECOND / sysconf(_SC_CLK_TCK);
+    return (Sint64)now.tv_sec * SDL_NS_PER_SECOND + now.tv_nsec - start;
+#else
+    return 0;
+#endif
+}
@@ -0,0 +1,38 @@
+/* 
+  A fully functional SDL3 window with a custom-drawn non-client area and shadow 
+  Copyright (C) 2025 fischflocke
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACE_H
+#define TRACE_H
+
+// Standard includes
+#include <stdbool.h>
+
+// SDL3 includes
+#include <SDL3/SDL.h>
+
+void initTrace(void);
+Uint64 traceNow(void);
+void setTraceClock(Uint64 (*clock)(void));
+Sint64 traceOrigin(void);
+void traceSpan(const char *name, Uint64 start, Uint64 end);
+void traceFlow(const char *name, Uint64 start, Uint64 end);
+Uint64 getTraceDuration(const char *name);
+void printTrace(void);
+bool writeTrace(const char *path);
+
+#endif